@@ -0,0 +1,191 @@
+// Banner downloads the old way (a HEAD and then a GET on new curl handles
+// per URL, four at a time) against BannerFetcher (one multi handle, single
+// GETs), both from a local stand-in for the Steam CDN. The stand-in delays
+// every new connection to stand in for a TLS handshake, answers HEAD and
+// GET with keep-alive, and has no library_hero.jpg for every fourth app, so
+// the header.jpg fallback is exercised.
+//
+//   BannerBench [banners] [handshake ms]    (default 60, 30)
+#include "../include/MultiLauncher/BannerFetcher.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MultiLauncher;
+namespace fs = std::filesystem;
+
+static constexpr size_t BannerBytes = 200 * 1024;
+
+class StandInCdn {
+public:
+    std::atomic<int> connections{0};
+    std::atomic<int> requests{0};
+
+    explicit StandInCdn(int handshakeMs) : handshakeMs_(handshakeMs), body_(BannerBytes, 'x') {
+        listen_ = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listen_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listen_, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(listen_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+        listen(listen_, 64);
+        acceptor_ = std::thread([this]() {
+            while (true) {
+                int fd = accept(listen_, nullptr, nullptr);
+                if (fd < 0) break;
+                connections++;
+                std::thread([this, fd]() { serve(fd); }).detach();
+            }
+        });
+    }
+    ~StandInCdn() {
+        shutdown(listen_, SHUT_RDWR);
+        close(listen_);
+        acceptor_.join();
+    }
+
+    std::string base() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+private:
+    int handshakeMs_;
+    std::string body_;
+    int listen_ = -1;
+    int port_ = 0;
+    std::thread acceptor_;
+
+    void serve(int fd) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(handshakeMs_));
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            std::string request = buffer.substr(0, end);
+            buffer.erase(0, end + 4);
+            requests++;
+            bool head = request.starts_with("HEAD");
+            size_t pathStart = request.find(' ') + 1;
+            std::string path = request.substr(pathStart, request.find(' ', pathStart) - pathStart);
+            int appId = std::atoi(path.c_str() + std::string("/steam/apps/").size());
+            bool found = !(path.ends_with("library_hero.jpg") && appId % 4 == 0);
+            std::string response = found ? "HTTP/1.1 200 OK\r\nContent-Type: image/jpeg\r\nContent-Length: " +
+                                               std::to_string(body_.size()) + "\r\n\r\n"
+                                         : "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+            if (found && !head) response += body_;
+            for (size_t sent = 0; sent < response.size();) {
+                ssize_t n = write(fd, response.data() + sent, response.size() - sent);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                sent += n;
+            }
+        }
+    }
+};
+
+// What Game::loadBanner did before BannerFetcher
+static bool oldDownload(const std::string& base, int appId, const std::string& local) {
+    auto urlExists = [](const std::string& url) {
+        CURL* curl = curl_easy_init();
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+        CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+        return res == CURLE_OK;
+    };
+    auto tryDownload = [&](const std::string& url) {
+        if (!urlExists(url)) return false;
+        CURL* curl = curl_easy_init();
+        FILE* file = fopen(local.c_str(), "wb");
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        CURLcode res = curl_easy_perform(curl);
+        fclose(file);
+        curl_easy_cleanup(curl);
+        return res == CURLE_OK;
+    };
+    std::string prefix = base + "/steam/apps/" + std::to_string(appId);
+    return tryDownload(prefix + "/library_hero.jpg") || tryDownload(prefix + "/header.jpg");
+}
+
+int main(int argc, char** argv) {
+    int banners = argc > 1 ? std::atoi(argv[1]) : 60;
+    int handshakeMs = argc > 2 ? std::atoi(argv[2]) : 30;
+    fs::path dir = fs::temp_directory_path() / "multilauncher_bannerbench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    auto report = [&](const char* name, StandInCdn& cdn, double ms, int ok) {
+        std::printf("  %-30s %8.1f ms  %3d/%d ok  %4d connections  %4d requests\n", name, ms, ok, banners,
+                    cdn.connections.load(), cdn.requests.load());
+    };
+    std::printf("%d banners of %zu KiB, %d ms per new connection\n", banners, BannerBytes / 1024, handshakeMs);
+
+    {
+        StandInCdn cdn(handshakeMs);
+        std::atomic<int> next{0}, ok{0};
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int w = 0; w < 4; ++w) {
+            workers.emplace_back([&]() {
+                for (int i; (i = next++) < banners;) {
+                    if (oldDownload(cdn.base(), i, (dir / ("old_" + std::to_string(i) + ".jpg")).string())) ok++;
+                }
+            });
+        }
+        for (auto& t : workers) t.join();
+        report("HEAD + GET, new handles", cdn, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), ok);
+    }
+
+    {
+        StandInCdn cdn(handshakeMs);
+        auto& fetcher = BannerFetcher::instance();
+        fetcher.setSteamCdn(cdn.base());
+        std::mutex m;
+        std::condition_variable cv;
+        int done = 0, ok = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < banners; ++i) {
+            fetcher.fetch(fetcher.steamUrls(i), (dir / ("new_" + std::to_string(i) + ".jpg")).string(), [&](bool success) {
+                std::lock_guard<std::mutex> lk(m);
+                done++;
+                if (success) ok++;
+                cv.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&]() { return done == banners; });
+        report("BannerFetcher (curl multi)", cdn, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), ok);
+        lk.unlock();
+        fetcher.shutdown();
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,112 @@
+// Compares one /proc walk per game (the old Game::isProcessRunning) with a
+// single ProcessSnapshot per tick, on a fake /proc tree.
+//
+//   ProcBench [processes] [games]    (default 500 processes, 200 games)
+#include "../include/MultiLauncher/ProcessSnapshot.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace MultiLauncher;
+namespace fs = std::filesystem;
+
+static void writeFakeProc(const fs::path& root, int processes) {
+    for (int pid = 1; pid <= processes; ++pid) {
+        fs::path dir = root / std::to_string(pid);
+        fs::create_directories(dir);
+        std::ofstream cmdline(dir / "cmdline", std::ios::binary);
+        if (pid % 10 == 0) continue; // kernel thread, empty cmdline
+        std::string argv0 = pid % 3 == 0 ? "Z:\\Games\\Proc" + std::to_string(pid) + "\\Game" + std::to_string(pid) + ".exe"
+                                         : "/usr/bin/process" + std::to_string(pid);
+        cmdline << argv0 << '\0' << "--some-flag" << '\0' << "--other=value" << '\0';
+    }
+    // non-pid entries that a walker has to skip
+    fs::create_directories(root / "sys");
+    fs::create_directories(root / "self");
+    std::ofstream(root / "uptime") << "1234.56 789.00\n";
+}
+
+// Game::isProcessRunning before ProcessSnapshot, with the root made configurable
+static bool oldIsProcessRunning(const fs::path& root, const std::string& processName) {
+    DIR* dir = opendir(root.c_str());
+    if (dir == nullptr) return false;
+    bool found = false;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_type != DT_DIR) continue;
+        bool isNumeric = true;
+        for (char* c = entry->d_name; *c; c++) {
+            if (!isdigit(*c)) {
+                isNumeric = false;
+                break;
+            }
+        }
+        if (!isNumeric) continue;
+        std::ifstream cmdlineFile(root.string() + "/" + entry->d_name + "/cmdline");
+        if (!cmdlineFile.is_open()) continue;
+        std::string cmdline;
+        std::getline(cmdlineFile, cmdline, '\0');
+        size_t lastSlash = cmdline.find_last_of('/');
+        std::string exeName = (lastSlash != std::string::npos) ? cmdline.substr(lastSlash + 1) : cmdline;
+        std::string searchName = processName;
+        std::transform(searchName.begin(), searchName.end(), searchName.begin(), ::tolower);
+        std::transform(exeName.begin(), exeName.end(), exeName.begin(), ::tolower);
+        if (searchName == exeName) {
+            found = true;
+            break;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+static double timeMs(const std::function<void()>& fn, int reps) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+int main(int argc, char** argv) {
+    int processes = argc > 1 ? std::atoi(argv[1]) : 500;
+    int games = argc > 2 ? std::atoi(argv[2]) : 200;
+    fs::path root = fs::temp_directory_path() / "multilauncher_procbench";
+    fs::remove_all(root);
+    writeFakeProc(root, processes);
+
+    // Mostly not running, like a real library; a few match the fake processes
+    std::vector<std::string> exeNames;
+    for (int i = 0; i < games; ++i) {
+        exeNames.push_back(i % 50 == 0 ? "process" + std::to_string(i + 1) : "SyntheticGame" + std::to_string(i) + ".exe");
+    }
+
+    size_t oldHits = 0, newHits = 0;
+    double oldTick = timeMs([&]() {
+        oldHits = 0;
+        for (const auto& exe : exeNames) oldHits += oldIsProcessRunning(root, exe);
+    }, 3);
+    double snapshotOnly = 0;
+    double newTick = timeMs([&]() {
+        auto start = std::chrono::steady_clock::now();
+        ProcessSnapshot snap = ProcessSnapshot::capture(root);
+        snapshotOnly += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        newHits = 0;
+        for (const auto& exe : exeNames) newHits += snap.contains(exe);
+    }, 20);
+    snapshotOnly /= 20;
+
+    std::printf("%d processes, %d games, one update() tick\n", processes, games);
+    std::printf("  walk per game      %10.3f ms  (%zu running)\n", oldTick, oldHits);
+    std::printf("  ProcessSnapshot    %10.3f ms  (%zu running, capture %.3f ms)  %.0fx\n", newTick, newHits, snapshotOnly,
+                oldTick / newTick);
+
+    fs::remove_all(root);
+    return oldHits != newHits;
+}
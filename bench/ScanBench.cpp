@@ -0,0 +1,218 @@
+// Times the scanners and GameManager::scanAll on a generated library.
+//
+//   ScanBench [games...]    (default 100 1000 10000)
+//
+// For every size it writes, under the temp directory:
+//   steam/   libraryfolders.vdf with SteamLibraries libraries sharing the appmanifests
+//   gog/     one directory per game with goggame-<id>.info and a few game files
+//   epic/    a stub legendary that prints a `list --json` result of that size
+// "cold" runs use a new scanner, "warm" runs repeat the scan on the same one.
+//
+// For the largest size it then simulates the render thread during repeated
+// scans and process checks: a frame that holds lockGames() while walking the
+// list, as Gui::render used to, against one that reads snapshot().
+#define STB_IMAGE_IMPLEMENTATION
+#include "../include/external/stb_image.h"
+#include "../include/MultiLauncher/GameManager.hpp"
+#include "../include/MultiLauncher/SteamScanner.hpp"
+#include "../include/MultiLauncher/GogScanner.hpp"
+#include "../include/MultiLauncher/EpicScanner.hpp"
+#include "../include/MultiLauncher/FrameStats.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace MultiLauncher;
+namespace fs = std::filesystem;
+
+static constexpr int SteamLibraries = 4;
+
+static void writeSteam(const fs::path& root, int games) {
+    fs::create_directories(root / "steamapps");
+    std::ofstream folders(root / "steamapps" / "libraryfolders.vdf");
+    folders << "\"libraryfolders\"\n{\n";
+    for (int lib = 0; lib < SteamLibraries; ++lib) {
+        fs::path libPath = root / ("library" + std::to_string(lib));
+        fs::create_directories(libPath / "steamapps");
+        folders << "\t\"" << lib << "\"\n\t{\n"
+                << "\t\t\"path\"\t\t\"" << libPath.generic_string() << "\"\n"
+                << "\t\t\"label\"\t\t\"\"\n"
+                << "\t\t\"contentid\"\t\t\"123456789\"\n"
+                << "\t\t\"apps\"\n\t\t{\n";
+        for (int i = lib; i < games; i += SteamLibraries) folders << "\t\t\t\"" << 10 + i << "\"\t\t\"123456789\"\n";
+        folders << "\t\t}\n\t}\n";
+    }
+    folders << "}\n";
+
+    for (int i = 0; i < games; ++i) {
+        int appid = 10 + i;
+        std::ofstream out(root / ("library" + std::to_string(i % SteamLibraries)) / "steamapps" /
+                          ("appmanifest_" + std::to_string(appid) + ".acf"));
+        out << "\"AppState\"\n{\n"
+            << "\t\"appid\"\t\t\"" << appid << "\"\n"
+            << "\t\"Universe\"\t\t\"1\"\n"
+            << "\t\"name\"\t\t\"Synthetic Game " << appid << "\"\n"
+            << "\t\"StateFlags\"\t\t\"4\"\n"
+            << "\t\"installdir\"\t\t\"Synthetic Game " << appid << "\"\n"
+            << "\t\"SizeOnDisk\"\t\t\"123456789\"\n"
+            << "\t\"InstalledDepots\"\n\t{\n\t\t\"" << appid + 1 << "\"\n\t\t{\n\t\t\t\"manifest\"\t\t\"1234567890\"\n\t\t\t\"size\"\t\t\"123456789\"\n\t\t}\n\t}\n"
+            << "\t\"UserConfig\"\n\t{\n\t\t\"language\"\t\t\"english\"\n\t}\n"
+            << "}\n";
+    }
+}
+
+static void writeGog(const fs::path& root, int games) {
+    for (int i = 0; i < games; ++i) {
+        std::string id = std::to_string(1000000000 + i);
+        fs::path dir = root / ("GOG Game " + std::to_string(i));
+        fs::create_directories(dir / "data");
+        std::ofstream info(dir / ("goggame-" + id + ".info"));
+        info << "{\n  \"buildId\": \"5" << i << "\",\n  \"gameId\": \"" << id << "\",\n"
+             << "  \"language\": \"English\",\n  \"name\": \"GOG Game " << i << "\",\n"
+             << "  \"playTasks\": [ { \"category\": \"game\", \"isPrimary\": true, \"name\": \"GOG Game " << i << "\","
+             << " \"path\": \"bin/game.exe\", \"type\": \"FileTask\" } ],\n  \"rootGameId\": \"" << id << "\",\n"
+             << "  \"version\": 1\n}\n";
+        // something for a recursive walk to trip over
+        std::ofstream(dir / "data" / "assets.pak") << "pak";
+        std::ofstream(dir / "data" / ("goggame-" + id + ".hashdb")) << "hash";
+    }
+}
+
+// Returns the stub to hand to EpicProvider::setLegendaryBinary
+static fs::path writeEpic(const fs::path& root, int games) {
+    fs::create_directories(root);
+    std::ofstream list(root / "list.json");
+    list << "[";
+    for (int i = 0; i < games; ++i) {
+        if (i) list << ", ";
+        list << "{\"app_name\": \"synthetic" << i << "\", \"app_title\": \"Legendary Game " << i << "\", "
+             << "\"title\": \"Legendary Game " << i << "\", \"asset_infos\": {\"Windows\": {\"app_name\": \"synthetic" << i
+             << "\", \"asset_id\": \"" << i << "\", \"build_version\": \"1.0." << i << "\", \"catalog_item_id\": \"0123456789abcdef"
+             << i << "\", \"label_name\": \"Live\", \"namespace\": \"ns" << i << "\"}}, \"base_urls\": [], "
+             << "\"metadata\": {\"description\": \"A synthetic game used to benchmark the Epic scanner.\", "
+             << "\"developer\": \"Synthetic Studio\", \"categories\": [{\"path\": \"games\"}, {\"path\": \"applications\"}]}}";
+    }
+    list << "]\n";
+    list.close();
+#ifdef _WIN32
+    fs::path stub = root / "legendary.bat";
+    std::ofstream(stub) << "@type \"" << (root / "list.json").string() << "\"\r\n";
+#else
+    fs::path stub = root / "legendary";
+    std::ofstream(stub) << "#!/bin/sh\nexec cat '" << (root / "list.json").string() << "'\n";
+    fs::permissions(stub, fs::perms::owner_exec, fs::perm_options::add);
+#endif
+    return stub;
+}
+
+static double timeMs(const std::function<void()>& fn, int reps) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+// Frame work only (no vsync wait), at ~60 fps while the main thread keeps
+// scanning and checking processes
+static FrameStats::Summary renderDuringScans(GameManager& manager, bool snapshot, int scans) {
+    FrameStats stats;
+    std::atomic<bool> done = false;
+    size_t sink = 0;
+    std::thread render([&]() {
+        while (!done) {
+            auto start = std::chrono::steady_clock::now();
+            if (snapshot) {
+                auto snap = manager.snapshot();
+                for (const auto& e : snap->games) sink += e.game->getName().size() + (size_t)e.status;
+            } else {
+                auto lock = manager.lockGames();
+                for (const auto& g : manager.getGames()) sink += g->getName().size() + (size_t)g->status.load();
+            }
+            stats.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            std::this_thread::sleep_until(start + std::chrono::microseconds(16667));
+        }
+    });
+    for (int i = 0; i < scans; ++i) {
+        manager.scanAll();
+        manager.update();
+    }
+    done = true;
+    render.join();
+    auto s = stats.summarize();
+    s.frames += sink == 0; // keep the loop
+    return s;
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::atoi(argv[i]));
+    if (sizes.empty()) sizes = { 100, 1000, 10000 };
+
+    fs::path base = fs::temp_directory_path() / "multilauncher_scanbench";
+    fs::path cwd = fs::current_path();
+
+    std::printf("%8s %12s %12s %10s %10s %14s %14s\n", "games", "Steam cold", "Steam warm", "GOG", "Epic",
+                "scanAll cold", "scanAll warm");
+    size_t sink = 0;
+    for (int games : sizes) {
+        fs::remove_all(base);
+        writeSteam(base / "steam", games);
+        writeGog(base / "gog", games);
+        EpicProvider::setLegendaryBinary(writeEpic(base / "epic", games).string());
+        fs::path libraryFolders = base / "steam" / "steamapps" / "libraryfolders.vdf";
+        // scanAll writes library.idx into the working directory
+        fs::current_path(base);
+
+        int reps = games >= 10000 ? 2 : 5;
+        double steamCold = timeMs([&]() { sink += SteamScanner(libraryFolders).scan().size(); }, reps);
+        SteamScanner steam(libraryFolders);
+        sink += steam.scan().size();
+        double steamWarm = timeMs([&]() { sink += steam.scan().size(); }, reps);
+        double gog = timeMs([&]() { sink += GogScanner(base / "gog").scan().size(); }, reps);
+        double epic = timeMs([&]() { sink += EpicScanner().scan().size(); }, reps);
+
+        double allCold = 0, allWarm = 0;
+        for (int r = 0; r < reps; ++r) {
+            GameManager manager;
+            manager.addScanner(std::make_unique<SteamScanner>(libraryFolders));
+            manager.addScanner(std::make_unique<EpicScanner>());
+            manager.addScanner(std::make_unique<GogScanner>(base / "gog"));
+            allCold += timeMs([&]() { manager.scanAll(); }, 1);
+            allWarm += timeMs([&]() { manager.scanAll(); }, 1);
+            auto lock = manager.lockGames();
+            sink += manager.getGames().size();
+        }
+        allCold /= reps;
+        allWarm /= reps;
+
+        fs::current_path(cwd);
+        std::printf("%8d %10.2fms %10.2fms %8.2fms %8.2fms %12.2fms %12.2fms\n", games, steamCold, steamWarm, gog, epic,
+                    allCold, allWarm);
+        std::fflush(stdout);
+    }
+
+    // Render thread vs. scans, on the last (largest) library
+    {
+        fs::path libraryFolders = base / "steam" / "steamapps" / "libraryfolders.vdf";
+        fs::current_path(base);
+        std::printf("\nrender thread during scanAll + update, %d games\n", sizes.back());
+        for (bool snapshot : { false, true }) {
+            GameManager manager;
+            manager.addScanner(std::make_unique<SteamScanner>(libraryFolders));
+            manager.addScanner(std::make_unique<EpicScanner>());
+            manager.addScanner(std::make_unique<GogScanner>(base / "gog"));
+            auto s = renderDuringScans(manager, snapshot, 5);
+            std::printf("  %-22s %s\n", snapshot ? "snapshot()" : "lockGames() per frame", s.toString().c_str());
+        }
+        fs::current_path(cwd);
+    }
+
+    fs::remove_all(base);
+    return sink == 0;
+}
@@ -0,0 +1,144 @@
+// Output throughput of popen + fgets (how ProcessRunner ran legendary before)
+// against ProcessRunner::spawn (posix_spawn + poll + 64 KiB reads), on a child that
+// prints a legendary-style install log. Then the cost of extracting progress
+// from those lines: std::regex against LegendaryProgressParser.
+//
+//   SpawnBench [lines]    (default 500000)
+#include "../include/MultiLauncher/ProcessRunner.hpp"
+#include "../include/MultiLauncher/InstallProgress.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <array>
+#include <sys/wait.h>
+#include <regex>
+#include <vector>
+#include <string>
+#include <string_view>
+
+using namespace MultiLauncher;
+namespace fs = std::filesystem;
+
+// Progress lines like `legendary install` prints, most longer than fgets' 128 bytes
+static void writeLog(const fs::path& path, int lines) {
+    std::ofstream out(path, std::ios::binary);
+    for (int i = 0; i < lines; ++i) {
+        int pct = i * 100 / lines;
+        switch (i % 4) {
+        case 0:
+            out << "[DLManager] INFO: = Progress: " << pct << ".00% (" << i << "/" << lines
+                << "), Running for 00:01:23, ETA: 00:12:34\n";
+            break;
+        case 1:
+            out << "[DLManager] INFO:  - Downloaded: 1234.56 MiB, Written: 2345.67 MiB\n";
+            break;
+        case 2:
+            out << "[DLManager] INFO:  - Cache usage: 123.45 MiB, active tasks: 16\n";
+            break;
+        default:
+            out << "[DLManager] INFO:  + Download\t- 45.67 MiB/s (raw) / 89.01 MiB/s (decompressed), chunk "
+                << i << " of " << lines << " from https://download.epicgames.com/Builds/Org/o-abcdef/Chunks/V3/"
+                << i % 97 << "/0123456789ABCDEF_0123456789ABCDEF0123456789ABCDEF.chunk\n";
+            break;
+        }
+    }
+}
+
+// The shell runner spawn() replaced: popen with stderr merged, fgets in 128-byte pieces
+static int popenRun(const std::string& command, const std::function<void(const std::string&)>& callback) {
+    std::array<char, 128> buffer;
+    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen((command + " 2>&1").c_str(), "r"), pclose);
+    if (!pipe) return -1;
+    while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
+        std::string line(buffer.data());
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+        callback(line);
+    }
+    int returnCode = pclose(pipe.release());
+    return WIFEXITED(returnCode) ? WEXITSTATUS(returnCode) : -1;
+}
+
+struct Result {
+    double ms = 0;
+    size_t lines = 0;
+    size_t bytes = 0;
+};
+
+int main(int argc, char** argv) {
+    int lines = argc > 1 ? std::atoi(argv[1]) : 500000;
+    fs::path log = fs::temp_directory_path() / "multilauncher_spawnbench.log";
+    writeLog(log, lines);
+
+    auto time = [](auto&& fn) {
+        Result r;
+        auto start = std::chrono::steady_clock::now();
+        fn(r);
+        r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return r;
+    };
+
+    Result popen = time([&](Result& r) {
+        popenRun("cat '" + log.string() + "'", [&](const std::string& line) {
+            r.lines++;
+            r.bytes += line.size();
+        });
+    });
+    Result spawn = time([&](Result& r) {
+        ProcessRunner::spawn({ "cat", log.string() }, [&](std::string_view line) {
+            r.lines++;
+            r.bytes += line.size();
+        });
+    });
+
+    auto print = [lines](const char* name, const Result& r) {
+        std::printf("  %-24s %9.1f ms  %12.0f lines/s  (%zu callbacks, %zu bytes)\n", name, r.ms, lines / (r.ms / 1000.0),
+                    r.lines, r.bytes);
+    };
+    std::printf("%d lines, %.1f MiB\n", lines, fs::file_size(log) / (1024.0 * 1024.0));
+    print("popen, fgets", popen);
+    print("spawn (posix_spawn)", spawn);
+    std::printf("  speedup %.1fx\n", popen.ms / spawn.ms);
+
+    std::vector<std::string> text;
+    {
+        std::ifstream in(log, std::ios::binary);
+        for (std::string line; std::getline(in, line);) text.push_back(std::move(line));
+    }
+    // What installGame did before the parser: percent and ETA only
+    size_t regexHits = 0, parserHits = 0;
+    Result regex = time([&](Result&) {
+        static const std::regex progressRegex(R"(Progress: ([\d\.]+)%.*ETA: (\d+:\d+:\d+))");
+        std::match_results<std::string_view::const_iterator> match;
+        float percent = 0;
+        for (std::string_view line : text) {
+            if (std::regex_search(line.begin(), line.end(), match, progressRegex)) {
+                percent = std::stof(match[1].str());
+                regexHits++;
+            }
+        }
+        (void)percent;
+    });
+    InstallProgress last;
+    Result parser = time([&](Result&) {
+        LegendaryProgressParser p;
+        for (std::string_view line : text) {
+            if (p.feed(line)) parserHits++;
+        }
+        last = p.progress();
+    });
+    auto printParse = [&text](const char* name, const Result& r, size_t hits) {
+        std::printf("  %-24s %9.1f ms  %12.0f lines/s  (%zu progress lines)\n", name, r.ms, text.size() / (r.ms / 1000.0), hits);
+    };
+    std::printf("parsing %zu lines\n", text.size());
+    printParse("std::regex", regex, regexHits);
+    printParse("LegendaryProgressParser", parser, parserHits);
+    std::printf("  speedup %.1fx, last: %.2f%%, %s\n", regex.ms / parser.ms, last.percent, last.toString().c_str());
+
+    fs::remove(log);
+    // fgets splits lines longer than its buffer; spawn must deliver each line once
+    return spawn.lines != (size_t)lines;
+}
@@ -0,0 +1,108 @@
+// Compares the tyti tree parser with VdfReader on synthetic Steam files.
+//
+//   VdfBench [apps]    (default 20000 apps in localconfig.vdf, ~6 MB)
+#include "../include/MultiLauncher/MappedFile.hpp"
+#include "../include/MultiLauncher/VdfReader.hpp"
+#include "../include/external/ValveFileVDF/vdf_parser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+using namespace MultiLauncher;
+namespace fs = std::filesystem;
+
+static void writeLocalConfig(const fs::path& path, int apps) {
+    std::ofstream out(path);
+    out << "\"UserLocalConfigStore\"\n{\n\t\"Software\"\n\t{\n\t\t\"Valve\"\n\t\t{\n\t\t\t\"Steam\"\n\t\t\t{\n\t\t\t\t\"apps\"\n\t\t\t\t{\n";
+    for (int i = 0; i < apps; ++i) {
+        out << "\t\t\t\t\t\"" << (10 + i * 10) << "\"\n\t\t\t\t\t{\n"
+            << "\t\t\t\t\t\t\"LastPlayed\"\t\t\"" << (1700000000 + i) << "\"\n"
+            << "\t\t\t\t\t\t\"Playtime\"\t\t\"" << (i % 5000) << "\"\n"
+            << "\t\t\t\t\t\t\"Playtime2wks\"\t\t\"" << (i % 60) << "\"\n"
+            << "\t\t\t\t\t\t\"cloud\"\n\t\t\t\t\t\t{\n\t\t\t\t\t\t\t\"last_sync_state\"\t\t\"synchronized\"\n\t\t\t\t\t\t}\n"
+            << "\t\t\t\t\t\t\"LaunchOptions\"\t\t\"-novid -console \\\"quoted\\\" %command%\"\n"
+            << "\t\t\t\t\t}\n";
+    }
+    out << "\t\t\t\t}\n\t\t\t}\n\t\t}\n\t}\n}\n";
+}
+
+static void writeManifest(const fs::path& path, int appid) {
+    std::ofstream out(path);
+    out << "\"AppState\"\n{\n"
+        << "\t\"appid\"\t\t\"" << appid << "\"\n"
+        << "\t\"Universe\"\t\t\"1\"\n"
+        << "\t\"name\"\t\t\"Synthetic Game " << appid << "\"\n"
+        << "\t\"StateFlags\"\t\t\"4\"\n"
+        << "\t\"installdir\"\t\t\"Synthetic Game " << appid << "\"\n"
+        << "\t\"SizeOnDisk\"\t\t\"123456789\"\n"
+        << "\t\"InstalledDepots\"\n\t{\n\t\t\"" << appid + 1 << "\"\n\t\t{\n\t\t\t\"manifest\"\t\t\"1234567890\"\n\t\t\t\"size\"\t\t\"123456789\"\n\t\t}\n\t}\n"
+        << "\t\"UserConfig\"\n\t{\n\t\t\"language\"\t\t\"english\"\n\t}\n"
+        << "}\n";
+}
+
+static double timeMs(const std::function<void()>& fn, int reps) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / reps;
+}
+
+int main(int argc, char** argv) {
+    int apps = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int manifests = 2000;
+    fs::path dir = fs::temp_directory_path() / "multilauncher_vdfbench";
+    fs::remove_all(dir);
+    fs::create_directories(dir / "steamapps");
+
+    fs::path localconfig = dir / "localconfig.vdf";
+    writeLocalConfig(localconfig, apps);
+    for (int i = 0; i < manifests; ++i) writeManifest(dir / "steamapps" / ("appmanifest_" + std::to_string(10 + i) + ".acf"), 10 + i);
+    double mb = fs::file_size(localconfig) / (1024.0 * 1024.0);
+
+    long sink = 0;
+    double tytiLocal = timeMs([&]() {
+        std::ifstream in(localconfig);
+        auto root = tyti::vdf::read(in);
+        sink += (long)root.childs.size();
+    }, 5);
+    double readerLocal = timeMs([&]() {
+        MappedFile file(localconfig);
+        VdfReader reader(file.view());
+        VdfReader::Event ev;
+        while (reader.next(ev)) {
+            if (ev.type == VdfReader::Event::KeyValue && ev.key == "Playtime") sink++;
+        }
+    }, 5);
+
+    double tytiManifests = timeMs([&]() {
+        for (int i = 0; i < manifests; ++i) {
+            std::ifstream in(dir / "steamapps" / ("appmanifest_" + std::to_string(10 + i) + ".acf"));
+            auto root = tyti::vdf::read(in);
+            sink += (long)root.attribs.size();
+        }
+    }, 3);
+    double readerManifests = timeMs([&]() {
+        for (int i = 0; i < manifests; ++i) {
+            MappedFile file(dir / "steamapps" / ("appmanifest_" + std::to_string(10 + i) + ".acf"));
+            VdfReader reader(file.view());
+            VdfReader::Event ev;
+            while (reader.next(ev)) {
+                if (ev.type == VdfReader::Event::ObjectBegin && reader.depth() > 1) reader.skipObject();
+                else if (ev.type == VdfReader::Event::KeyValue && ev.key == "name") sink++;
+            }
+        }
+    }, 3);
+
+    std::printf("localconfig.vdf  %.1f MB, %d apps\n", mb, apps);
+    std::printf("  tyti::vdf::read  %8.2f ms  %7.1f MB/s\n", tytiLocal, mb / (tytiLocal / 1000.0));
+    std::printf("  VdfReader        %8.2f ms  %7.1f MB/s  (%.1fx)\n", readerLocal, mb / (readerLocal / 1000.0), tytiLocal / readerLocal);
+    std::printf("%d appmanifest_*.acf\n", manifests);
+    std::printf("  tyti::vdf::read  %8.2f ms\n", tytiManifests);
+    std::printf("  VdfReader        %8.2f ms  (%.1fx)\n", readerManifests, tytiManifests / readerManifests);
+
+    fs::remove_all(dir);
+    return sink == 0;
+}
@@ -0,0 +1,245 @@
+#pragma once
+#ifndef _WIN32
+#include "Logger.hpp"
+#include "TransferScheduler.hpp"
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+
+namespace MultiLauncher {
+
+    // Downloads banner images on one thread driving one curl multi handle.
+    // Transfers share its connection and DNS caches, so banners from the same
+    // CDN reuse a connection, multiplexed over HTTP/2 where the server offers
+    // it. At most MaxActive transfers run at once, the rest wait in order.
+    //
+    // Each fetch is a single GET per URL; a failed one (a 404 included)
+    // moves on to the next URL. Error responses are read and dropped rather
+    // than failing the transfer early, which would close the connection. Data goes to `<path>.part` and is renamed into place
+    // only when complete, so a cut-off download never passes as a cached
+    // banner. Downloads draw from the transfer budget.
+    class BannerFetcher {
+    public:
+        static constexpr int MaxActive = 6;
+        static constexpr int MaxPerHost = 2;
+        static constexpr long ConnectTimeoutMs = 5000;
+        static constexpr long TransferTimeoutMs = 30000;
+        // Abort a stalled transfer: below LowSpeedBytes/s for LowSpeedSeconds
+        static constexpr long LowSpeedBytes = 1024;
+        static constexpr long LowSpeedSeconds = 10;
+
+        static BannerFetcher& instance() {
+            static BannerFetcher inst;
+            return inst;
+        }
+
+        // "https://cdn.cloudflare.steamstatic.com"; point it at a local server
+        // to test
+        void setSteamCdn(const std::string& base) {
+            std::lock_guard<std::mutex> lk(m_);
+            steamCdn_ = base;
+        }
+
+        // The hero image, with the smaller header as fallback
+        std::vector<std::string> steamUrls(int appId) const {
+            std::lock_guard<std::mutex> lk(m_);
+            std::string base = steamCdn_ + "/steam/apps/" + std::to_string(appId);
+            return { base + "/library_hero.jpg", base + "/header.jpg" };
+        }
+
+        // Fetches the first of `urls` that succeeds to `path`. `done` runs on
+        // the fetcher thread, with false if every URL failed or the fetcher
+        // shut down; keep it short. Returns false if already shut down.
+        bool fetch(std::vector<std::string> urls, const std::string& path, std::function<void(bool)> done) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (stopping_ || !multi_) return false;
+                auto request = std::make_unique<Request>();
+                request->urls = std::move(urls);
+                request->path = path;
+                request->done = std::move(done);
+                pending_.push_back(std::move(request));
+                if (!thread_.joinable()) thread_ = std::thread([this]() { loop(); });
+            }
+            curl_multi_wakeup(multi_);
+            return true;
+        }
+
+        // Aborts running transfers and fails waiting ones. Called on exit.
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (stopping_) return;
+                stopping_ = true;
+            }
+            if (multi_) curl_multi_wakeup(multi_);
+            if (thread_.joinable()) thread_.join();
+        }
+
+    private:
+        BannerFetcher() {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            multi_ = curl_multi_init();
+            if (!multi_) {
+                Logger::instance().error("Banner downloads unavailable: curl_multi_init failed");
+                return;
+            }
+            curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, (long)MaxPerHost);
+            curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)MaxActive);
+        }
+        ~BannerFetcher() {
+            shutdown();
+            if (multi_) curl_multi_cleanup(multi_);
+        }
+
+        struct Request {
+            std::vector<std::string> urls;
+            size_t next = 0;
+            std::string path;
+            std::function<void(bool)> done;
+            FILE* file = nullptr;
+            CURL* easy = nullptr;
+        };
+
+        mutable std::mutex m_;
+        std::deque<std::unique_ptr<Request> > pending_;
+        bool stopping_ = false;
+        std::string steamCdn_ = "https://cdn.cloudflare.steamstatic.com";
+        CURLM* multi_ = nullptr;
+        std::thread thread_;
+        // fetcher thread only
+        std::vector<std::unique_ptr<Request> > active_;
+
+        static size_t write(char* data, size_t size, size_t count, void* user) {
+            Request* r = static_cast<Request*>(user);
+            // error pages are dropped; reading them keeps the connection reusable
+            long status = 0;
+            curl_easy_getinfo(r->easy, CURLINFO_RESPONSE_CODE, &status);
+            if (status >= 400) return size * count;
+            TransferScheduler::instance().acquireDownload(size * count);
+            return std::fwrite(data, size, count, r->file);
+        }
+
+        static std::string partPath(const Request& r) { return r.path + ".part"; }
+
+        // Starts the request's next URL; false if none is left or it can't start
+        bool start(Request& r) {
+            while (r.next < r.urls.size()) {
+                const std::string& url = r.urls[r.next++];
+                r.file = std::fopen(partPath(r).c_str(), "wb");
+                if (!r.file) return false;
+                r.easy = curl_easy_init();
+                if (!r.easy) break;
+                curl_easy_setopt(r.easy, CURLOPT_URL, url.c_str());
+                curl_easy_setopt(r.easy, CURLOPT_PRIVATE, &r);
+                curl_easy_setopt(r.easy, CURLOPT_WRITEFUNCTION, write);
+                curl_easy_setopt(r.easy, CURLOPT_WRITEDATA, &r);
+                curl_easy_setopt(r.easy, CURLOPT_FOLLOWLOCATION, 1L);
+                curl_easy_setopt(r.easy, CURLOPT_USERAGENT, "Mozilla/5.0");
+                curl_easy_setopt(r.easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+                curl_easy_setopt(r.easy, CURLOPT_PIPEWAIT, 1L);
+                curl_easy_setopt(r.easy, CURLOPT_CONNECTTIMEOUT_MS, ConnectTimeoutMs);
+                curl_easy_setopt(r.easy, CURLOPT_TIMEOUT_MS, TransferTimeoutMs);
+                curl_easy_setopt(r.easy, CURLOPT_LOW_SPEED_LIMIT, LowSpeedBytes);
+                curl_easy_setopt(r.easy, CURLOPT_LOW_SPEED_TIME, LowSpeedSeconds);
+                curl_easy_setopt(r.easy, CURLOPT_NOSIGNAL, 1L);
+                if (curl_multi_add_handle(multi_, r.easy) == CURLM_OK) return true;
+                close(r);
+            }
+            close(r);
+            return false;
+        }
+
+        void close(Request& r) {
+            if (r.easy) {
+                curl_multi_remove_handle(multi_, r.easy);
+                curl_easy_cleanup(r.easy);
+                r.easy = nullptr;
+            }
+            if (r.file) {
+                std::fclose(r.file);
+                r.file = nullptr;
+            }
+        }
+
+        void finish(std::unique_ptr<Request> r, bool ok) {
+            close(*r);
+            std::error_code ec;
+            if (ok) std::filesystem::rename(partPath(*r), r->path, ec);
+            bool stored = ok && !ec;
+            if (!stored) std::filesystem::remove(partPath(*r), ec);
+            if (r->done) r->done(stored);
+        }
+
+        void loop() {
+            while (true) {
+                std::deque<std::unique_ptr<Request> > starting;
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    if (stopping_) break;
+                    while (!pending_.empty() && active_.size() + starting.size() < (size_t)MaxActive) {
+                        starting.push_back(std::move(pending_.front()));
+                        pending_.pop_front();
+                    }
+                }
+                for (auto& r : starting) {
+                    if (start(*r)) active_.push_back(std::move(r));
+                    else finish(std::move(r), false);
+                }
+
+                int running = 0;
+                curl_multi_perform(multi_, &running);
+                int queued = 0;
+                bool freed = false;
+                while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+                    if (msg->msg != CURLMSG_DONE) continue;
+                    Request* r = nullptr;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &r);
+                    CURLcode result = msg->data.result;
+                    long status = 0;
+                    curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+                    auto it = std::find_if(active_.begin(), active_.end(), [r](const auto& a) { return a.get() == r; });
+                    if (it == active_.end()) continue;
+                    if (result == CURLE_OK && status < 400) {
+                        auto done = std::move(*it);
+                        active_.erase(it);
+                        finish(std::move(done), true);
+                        freed = true;
+                        continue;
+                    }
+                    close(*r);
+                    if (r->next < r->urls.size() && start(*r)) continue; // the fallback URL
+                    std::string reason = result != CURLE_OK ? curl_easy_strerror(result) : "HTTP " + std::to_string(status);
+                    Logger::instance().error("Banner download failed: " + r->urls.back() + " (" + reason + ")");
+                    auto failed = std::move(*it);
+                    active_.erase(it);
+                    finish(std::move(failed), false);
+                    freed = true;
+                }
+                // a freed slot goes to the next waiting request right away
+                if (!freed) curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+            }
+
+            // stopping: abort what runs, fail what waits
+            for (auto& r : active_) finish(std::move(r), false);
+            active_.clear();
+            std::deque<std::unique_ptr<Request> > left;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                left.swap(pending_);
+            }
+            for (auto& r : left) finish(std::move(r), false);
+        }
+    };
+
+}
+#endif
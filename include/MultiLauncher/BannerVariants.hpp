@@ -0,0 +1,182 @@
+#pragma once
+#include "TextureUploader.hpp"
+#include "ImageResize.hpp"
+#include "Logger.hpp"
+#include "../external/stb_image.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace MultiLauncher {
+
+    // Display-sized copies of the banners in assets/cache. Steam heroes are
+    // 3840 pixels wide while the Details panel shows them at a few hundred,
+    // so uploading the original wastes memory and, minified without mips,
+    // shimmers. When a banner first enters the cache it is box-filtered down
+    // to each of Widths narrower than it, and every variant is stored with
+    // its mip chain next to the original as <original>.w<width>.mip. Loading
+    // takes the smallest variant at least as wide as the panel; the stored
+    // pixels go straight to the uploader with no decode.
+    //
+    // A .mip file is a header (magic, version, level count, then the width
+    // and height of each level) followed by the RGBA levels, largest first.
+    class BannerVariants {
+    public:
+        static constexpr int Widths[] = { 480, 960, 1920 };
+
+        static std::string variantPath(const std::string& original, int width) {
+            return original + ".w" + std::to_string(width) + ".mip";
+        }
+
+        // Worker thread: the image for a panel `displayWidth` pixels wide.
+        // With `cached`, the original is in assets/cache and variants are
+        // used, and written if missing; otherwise the original is decoded.
+        static MipImage load(const std::string& original, int displayWidth, bool cached) {
+            if (cached) {
+                for (int width : Widths) {
+                    if (width < displayWidth) continue;
+                    if (auto variant = read(original, width)) return variant;
+                }
+            }
+            MipImage source = decode(original);
+            if (!source || !cached) return source;
+            MipImage chosen = writeVariants(original, source, displayWidth);
+            return chosen ? std::move(chosen) : std::move(source);
+        }
+
+        // Worker thread, after `original` is downloaded to assets/cache
+        static void generate(const std::string& original) {
+            if (MipImage source = decode(original)) writeVariants(original, source, 0);
+        }
+
+    private:
+        static constexpr char Magic[4] = { 'M', 'L', 'B', 'V' };
+        static constexpr uint32_t Version = 1;
+
+        // The original with its mip chain
+        static MipImage decode(const std::string& path) {
+            int width = 0, height = 0, channels = 0;
+            unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+            if (!pixels) {
+                Logger::instance().error("Failed to load image: " + path + " - " + stbi_failure_reason());
+                return MipImage{};
+            }
+            MipImage image = MipImage::allocate(width, height, true);
+            if (image) {
+                std::memcpy(image.level(0), pixels, (size_t)width * height * 4);
+                buildMips(image);
+            }
+            stbi_image_free(pixels);
+            return image;
+        }
+
+        static void buildMips(MipImage& image) {
+            const auto& levels = image.levels();
+            for (size_t i = 1; i < levels.size(); ++i) {
+                ImageResize::halve(image.level(i - 1), levels[i - 1].width, levels[i - 1].height, image.level(i));
+            }
+        }
+
+        // Writes the variants of `source` that are missing or older than the
+        // original; returns the smallest at least `displayWidth` wide, if any
+        static MipImage writeVariants(const std::string& original, const MipImage& source, int displayWidth) {
+            auto start = std::chrono::steady_clock::now();
+            MipImage chosen;
+            std::string written;
+            for (int width : Widths) {
+                if (width >= source.width()) break;
+                bool wanted = !chosen && width >= displayWidth && displayWidth > 0;
+                if (!wanted && upToDate(original, width)) continue;
+                int height = std::max(1, (int)((int64_t)source.height() * width / source.width()));
+                MipImage variant = MipImage::allocate(width, height, true);
+                if (!variant) break;
+                ImageResize::box(source.level(0), source.width(), source.height(), variant.level(0), width, height);
+                buildMips(variant);
+                variant.downscaled = true;
+                // a wanted variant that exists did not read back; replace it
+                if (!write(variantPath(original, width), variant)) break;
+                written += (written.empty() ? "" : ", ") + std::to_string(width);
+                if (wanted) chosen = std::move(variant);
+            }
+            if (!written.empty()) {
+                char msg[64];
+                std::snprintf(msg, sizeof(msg), " in %.1f ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                Logger::instance().info("Banner variants for " + original + ": " + written + " px" + msg);
+            }
+            return chosen;
+        }
+
+        static bool upToDate(const std::string& original, int width) {
+            std::error_code ec;
+            auto variant = std::filesystem::last_write_time(variantPath(original, width), ec);
+            if (ec) return false;
+            auto source = std::filesystem::last_write_time(original, ec);
+            return !ec && variant >= source;
+        }
+
+        static MipImage read(const std::string& original, int width) {
+            if (!upToDate(original, width)) return MipImage{};
+            std::string path = variantPath(original, width);
+            std::ifstream in(path, std::ios::binary);
+            char magic[4];
+            uint32_t version = 0, count = 0;
+            in.read(magic, 4);
+            in.read((char*)&version, sizeof(version));
+            in.read((char*)&count, sizeof(count));
+            if (!in || std::memcmp(magic, Magic, 4) != 0 || version != Version || count == 0 || count > 32) return MipImage{};
+            uint32_t size[2];
+            in.read((char*)size, sizeof(size));
+            in.seekg(sizeof(uint32_t) * 2 * (count - 1), std::ios::cur);
+            if (!in || size[0] == 0 || size[1] == 0 || size[0] > 16384 || size[1] > 16384) return MipImage{};
+            MipImage image = MipImage::allocate((int)size[0], (int)size[1], count > 1);
+            if (!image || image.levels().size() != count) return MipImage{};
+            in.read((char*)image.level(0), (std::streamsize)image.bytes());
+            if (!in) {
+                Logger::instance().error("Truncated banner variant: " + path);
+                return MipImage{};
+            }
+            image.downscaled = true;
+            return image;
+        }
+
+        static bool write(const std::string& path, const MipImage& image) {
+            // unique, so two writers of the same variant do not interleave
+            static std::atomic<unsigned> serial{0};
+            std::string part = path + ".part" + std::to_string(serial++);
+            {
+                std::ofstream out(part, std::ios::binary | std::ios::trunc);
+                uint32_t count = (uint32_t)image.levels().size();
+                out.write(Magic, 4);
+                out.write((const char*)&Version, sizeof(Version));
+                out.write((const char*)&count, sizeof(count));
+                for (const auto& level : image.levels()) {
+                    uint32_t size[2] = { (uint32_t)level.width, (uint32_t)level.height };
+                    out.write((const char*)size, sizeof(size));
+                }
+                out.write((const char*)image.level(0), (std::streamsize)image.bytes());
+                if (!out) {
+                    out.close();
+                    std::error_code ec;
+                    std::filesystem::remove(part, ec);
+                    Logger::instance().error("Failed to write banner variant: " + path);
+                    return false;
+                }
+            }
+            std::error_code ec;
+            std::filesystem::rename(part, path, ec);
+            if (ec) {
+                std::filesystem::remove(part, ec);
+                return false;
+            }
+            return true;
+        }
+    };
+
+}
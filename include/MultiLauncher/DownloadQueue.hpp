@@ -0,0 +1,352 @@
+#pragma once
+#include "Game.hpp"
+#include "GameCatalog.hpp"
+#include "EpicProvider.hpp"
+#include "HardwareProbe.hpp"
+#include "Logger.hpp"
+#include "../external/JSON/json.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace MultiLauncher {
+
+    // Orders Epic installs and runs at most maxConcurrent() `legendary
+    // install` processes at a time, so they don't fight over disk and
+    // network. Higher priority runs first, then the order in the list.
+    //
+    // Pausing interrupts legendary, which keeps its resume state; resuming
+    // queues the game again and the next run continues with --repair. The
+    // queue survives restarts in download_queue.json: installs that were
+    // running or waiting are queued again on the next start.
+    class DownloadQueue {
+    public:
+        enum ItemState { Queued, Active, Paused, Failed };
+
+        struct Item {
+            std::string game;
+            std::string basePath;
+            int priority = 0;
+            ItemState state = Queued;
+            std::shared_ptr<Game> resolved; // null until the game is in the library
+        };
+
+        // Every install holds a Process lane worker until legendary exits;
+        // the reserve keeps workers free for games launched on Windows
+        static constexpr int ProcessReserve = 4;
+        static constexpr int MaxConcurrentLimit = (int)Executor::maxWorkers(Executor::Process) - ProcessReserve;
+
+        static DownloadQueue& instance() {
+            static DownloadQueue inst;
+            return inst;
+        }
+
+        // Looks up queued games by name; `resolve` matches it the way
+        // GameCatalog ids do, so a game a rescan renamed is still found. Call
+        // once the library index is loaded; the queue starts installing right away.
+        void attach(std::function<std::shared_ptr<Game>(const std::string&)> resolve) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                resolve_ = std::move(resolve);
+            }
+            pump();
+        }
+
+        int maxConcurrent() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return maxConcurrent_;
+        }
+
+        // Lowering it lets running installs finish; it only limits new starts
+        void setMaxConcurrent(int n) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                maxConcurrent_ = std::clamp(n, 1, MaxConcurrentLimit);
+            }
+            persist();
+            pump();
+        }
+
+        // Adds the game at the end of its priority, or resumes it if it is
+        // already in the queue
+        void enqueue(Game& game, const std::string& basePath = "", int priority = 0) {
+            bool added = false;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game.getName());
+                if (it != items_.end()) {
+                    if (it->state == Paused || it->state == Failed) it->state = Queued;
+                } else {
+                    Item item;
+                    item.game = game.getName();
+                    item.basePath = basePath;
+                    item.priority = priority;
+                    insertSorted(std::move(item));
+                    added = true;
+                }
+            }
+            if (added) Logger::instance().info("Queued install of " + game.getName());
+            persist();
+            pump();
+        }
+
+        void resume(const std::string& game) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game);
+                if (it == items_.end() || (it->state != Paused && it->state != Failed)) return;
+                it->state = Queued;
+            }
+            persist();
+            pump();
+        }
+
+        // Stops a running install (asynchronously) or holds a waiting one
+        void pause(const std::string& game) {
+            std::shared_ptr<Game> running;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game);
+                if (it == items_.end()) return;
+                if (it->state == Active) {
+                    running = it->resolved;
+                } else if (it->state == Queued) {
+                    it->state = Paused;
+                    if (it->resolved) it->resolved->status = Game::GameStatus::Paused;
+                }
+            }
+            persist();
+            // the install's completion marks the item Paused and starts the next one
+            if (running) EpicProvider::cancelInstall(*running);
+        }
+
+        // Drops a waiting, paused or failed item; a running one must be paused first
+        void remove(const std::string& game) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game);
+                if (it == items_.end() || it->state == Active) return;
+                if (it->resolved) {
+                    auto status = it->resolved->status.load();
+                    if (status == Game::GameStatus::Queued || status == Game::GameStatus::Paused ||
+                        status == Game::GameStatus::Error) {
+                        it->resolved->status = Game::GameStatus::Idle;
+                    }
+                }
+                items_.erase(it);
+            }
+            persist();
+        }
+
+        void setPriority(const std::string& game, int priority) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game);
+                if (it == items_.end() || it->priority == priority) return;
+                Item item = std::move(*it);
+                items_.erase(it);
+                item.priority = priority;
+                insertSorted(std::move(item));
+            }
+            persist();
+            pump();
+        }
+
+        // Swaps the item with its neighbour (-1 up, +1 down), taking the
+        // neighbour's priority so the new order holds
+        void move(const std::string& game, int delta) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = find(game);
+                if (it == items_.end()) return;
+                size_t i = (size_t)(it - items_.begin());
+                size_t j = i + delta;
+                if (delta == 0 || j >= items_.size()) return;
+                items_[i].priority = items_[j].priority;
+                std::swap(items_[i], items_[j]);
+            }
+            persist();
+            pump();
+        }
+
+        // In run order
+        std::vector<Item> items() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return items_;
+        }
+
+        // Re-resolves games and starts installs while slots are free. Called
+        // on every queue change; call it too when the library changed, so
+        // games that were not found yet get their place. The lookups (which
+        // take the library lock) and the starts run without m_ held.
+        void pump() {
+            std::function<std::shared_ptr<Game>(const std::string&)> resolve;
+            std::vector<std::string> names;
+            std::optional<std::string> next; // basePath of the first install, when none is running
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (stopping_ || !resolve_) return;
+                resolve = resolve_;
+                bool idle = std::none_of(items_.begin(), items_.end(), [](const Item& item) { return item.state == Active; });
+                for (const auto& item : items_) {
+                    if (item.state != Active) names.push_back(item.game);
+                    if (idle && !next && item.state == Queued) next = item.basePath;
+                }
+            }
+            // The target disk is measured while nothing writes to it, so the
+            // install is tuned for it; the queue goes on when the probe ends
+            if (next && HardwareProbe::instance().probeAsync(EpicProvider::installDir(*next), [this]() { pump(); })) return;
+            std::unordered_map<std::string, std::shared_ptr<Game> > resolved;
+            for (const auto& name : names) resolved[name] = resolve(name);
+
+            std::vector<Item> start;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (stopping_) return;
+                int active = 0;
+                for (auto& item : items_) {
+                    // a rescan may have replaced the Game object; a running install keeps its own
+                    if (item.state == Active) {
+                        active++;
+                        continue;
+                    }
+                    auto found = resolved.find(item.game);
+                    // queued while we were resolving: the next pump looks it up
+                    if (found == resolved.end()) continue;
+                    item.resolved = found->second;
+                    // follow a rename, so the saved queue uses the current name
+                    if (item.resolved) item.game = item.resolved->getName();
+                }
+                for (auto& item : items_) {
+                    if (!item.resolved) continue;
+                    Game& game = *item.resolved;
+                    if (item.state == Queued && active < maxConcurrent_) {
+                        item.state = Active;
+                        active++;
+                        start.push_back(item);
+                        continue;
+                    }
+                    // show queue state on games that are not installing
+                    auto status = game.status.load();
+                    if (status == Game::GameStatus::Idle || status == Game::GameStatus::Queued ||
+                        status == Game::GameStatus::Paused || status == Game::GameStatus::Error) {
+                        if (item.state == Queued) game.status = Game::GameStatus::Queued;
+                        else if (item.state == Paused) game.status = Game::GameStatus::Paused;
+                        else if (item.state == Failed) game.status = Game::GameStatus::Error;
+                    }
+                }
+            }
+            for (auto& item : start) {
+                std::string name = item.game;
+                bool started = EpicProvider::installGame(*item.resolved, item.basePath, [this, name](Game::GameStatus result) {
+                    finished(name, result);
+                });
+                if (!started) finished(name, Game::GameStatus::Error);
+            }
+        }
+
+        // On exit, before EpicProvider::stopInstalls: records running installs
+        // as queued so they continue on the next start, and ignores the
+        // interrupted processes' completions
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stopping_ = true;
+            }
+            persist();
+        }
+
+    private:
+        DownloadQueue() { load(); }
+
+        mutable std::mutex m_;
+        // Serializes writes of download_queue.json; taken before m_, never while holding it
+        std::mutex fileMutex_;
+        std::vector<Item> items_;
+        int maxConcurrent_ = 1;
+        bool stopping_ = false;
+        std::function<std::shared_ptr<Game>(const std::string&)> resolve_;
+
+        // By normalized name, like the Epic game ids: the item may still carry
+        // the name from before a rename
+        std::vector<Item>::iterator find(const std::string& game) {
+            std::string key = GameCatalog::normalizeName(game);
+            return std::find_if(items_.begin(), items_.end(), [&key](const Item& item) {
+                return GameCatalog::normalizeName(item.game) == key;
+            });
+        }
+
+        // After every item of the same or higher priority
+        void insertSorted(Item item) {
+            auto pos = std::find_if(items_.begin(), items_.end(), [&item](const Item& other) {
+                return other.priority < item.priority;
+            });
+            items_.insert(pos, std::move(item));
+        }
+
+        void finished(const std::string& game, Game::GameStatus result) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (stopping_) return;
+                auto it = find(game);
+                if (it == items_.end()) return;
+                if (result == Game::GameStatus::Idle) {
+                    Logger::instance().info("Finished install of " + game);
+                    items_.erase(it);
+                } else {
+                    it->state = result == Game::GameStatus::Paused ? Paused : Failed;
+                }
+            }
+            persist();
+            pump();
+        }
+
+        void load() {
+            if (!std::filesystem::exists("download_queue.json")) return;
+            try {
+                std::ifstream i("download_queue.json");
+                nlohmann::json j;
+                i >> j;
+                maxConcurrent_ = std::clamp(j.value("maxConcurrent", 1), 1, MaxConcurrentLimit);
+                for (const auto& entry : j["items"]) {
+                    Item item;
+                    item.game = entry.value("game", "");
+                    item.basePath = entry.value("basePath", "");
+                    item.priority = entry.value("priority", 0);
+                    std::string state = entry.value("state", "queued");
+                    item.state = state == "paused" ? Paused : state == "failed" ? Failed : Queued;
+                    if (!item.game.empty()) items_.push_back(std::move(item));
+                }
+            } catch (...) {}
+        }
+
+        // Writes the current state; m_ must not be held. Each write takes
+        // the state at its turn, so the file ends with the latest one.
+        void persist() {
+            std::lock_guard<std::mutex> file(fileMutex_);
+            try {
+                nlohmann::json j;
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    j["maxConcurrent"] = maxConcurrent_;
+                    j["items"] = nlohmann::json::array();
+                    for (const auto& item : items_) {
+                        static const char* states[] = { "queued", "queued", "paused", "failed" };
+                        j["items"].push_back({ { "game", item.game }, { "basePath", item.basePath },
+                                               { "priority", item.priority }, { "state", states[item.state] } });
+                    }
+                }
+                std::ofstream o("download_queue.json");
+                o << j.dump(2);
+            } catch (...) {}
+        }
+    };
+
+}
@@ -2,10 +2,19 @@
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <fstream>
 #include <cctype>
+#include <cstdlib>
 #include "Game.hpp"
 #include "ProcessRunner.hpp"
-#include <regex>
+#include "LaunchMetrics.hpp"
+#include "TransferScheduler.hpp"
+#include "HardwareProbe.hpp"
+#include <map>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <algorithm>
 #include "../external/JSON/json.hpp"
 using json = nlohmann::json;
 
@@ -17,7 +26,23 @@ namespace MultiLauncher {
 
     class EpicProvider {
     private:
+        static std::string& binaryOverride() {
+            static std::string path;
+            return path;
+        }
+
+        // Running `legendary install` processes by game name
+        struct Installs {
+            std::mutex m;
+            std::map<std::string, std::shared_ptr<ProcessHandle> > handles;
+        };
+        static Installs& installs() {
+            static Installs inst;
+            return inst;
+        }
+
         static std::string getLegendaryBinary() {
+            if (!binaryOverride().empty()) return binaryOverride();
 #ifdef _WIN32
             return "tools/legendary/legendary.exe";
 #else
@@ -26,12 +51,58 @@ namespace MultiLauncher {
         }
 
     public:
+        // Where legendary keeps user.json / installed.json
+        static std::filesystem::path configDir() {
+            if (const char* custom = std::getenv("LEGENDARY_CONFIG_PATH")) return custom;
+#ifdef _WIN32
+            const char* home = std::getenv("USERPROFILE");
+            return home ? std::filesystem::path(home) / ".config" / "legendary" : std::filesystem::path();
+#else
+            if (const char* xdg = std::getenv("XDG_CONFIG_HOME")) return std::filesystem::path(xdg) / "legendary";
+            const char* home = std::getenv("HOME");
+            return home ? std::filesystem::path(home) / ".config" / "legendary" : std::filesystem::path();
+#endif
+        }
+
+        // Where `legendary install` puts a game: basePath if given, else
+        // install_dir from legendary's config.ini, else its default ~/legendary
+        static std::filesystem::path installDir(const std::string& basePath = "") {
+            if (!basePath.empty()) return basePath;
+            std::ifstream config(configDir() / "config.ini");
+            std::string line;
+            bool legendarySection = false;
+            while (std::getline(config, line)) {
+                if (line.starts_with("[")) {
+                    legendarySection = line.starts_with("[Legendary]");
+                    continue;
+                }
+                if (!legendarySection || !line.starts_with("install_dir")) continue;
+                size_t eq = line.find('=');
+                if (eq == std::string::npos) continue;
+                size_t start = line.find_first_not_of(" \t", eq + 1);
+                size_t end = line.find_last_not_of(" \t\r");
+                if (start != std::string::npos && end >= start) return line.substr(start, end - start + 1);
+            }
+#ifdef _WIN32
+            const char* home = std::getenv("USERPROFILE");
+#else
+            const char* home = std::getenv("HOME");
+#endif
+            return home ? std::filesystem::path(home) / "legendary" : std::filesystem::path("legendary");
+        }
+
+        // Runs another legendary executable instead of the bundled one, e.g. a
+        // stub in benchmarks. Set it before any scan starts.
+        static void setLegendaryBinary(const std::string& path) {
+            binaryOverride() = path;
+        }
+
         static bool isAvailable() {
             return std::filesystem::exists(getLegendaryBinary());
         }
 
         static void authenticate() {
-            ProcessRunner::runAsync(getLegendaryBinary() + " auth", [](int code) {
+            ProcessRunner::spawnAsync({ getLegendaryBinary(), "auth" }, [](int code) {
                 Logger::instance().info("Legendary auth process completed with code: " + std::to_string(code));
             });
         }
@@ -43,12 +114,12 @@ namespace MultiLauncher {
 
             Logger::instance().info(std::string("Fetching Epic Games list via Legendary") + (forceRefresh ? " (forcing refresh)..." : "..."));
 
-            std::string cmd = getLegendaryBinary() + " --quiet list --json";
+            std::vector<std::string> args = { getLegendaryBinary(), "--quiet", "list", "--json" };
             if (forceRefresh) {
-                cmd += " --force-refresh";
+                args.push_back("--force-refresh");
             }
 
-            int exitCode = ProcessRunner::run(cmd, [&](const std::string& line) {
+            int exitCode = ProcessRunner::spawn(args, [&](std::string_view line) {
                 if (line.empty()) return;
 
                 // Better detection of JSON vs Log lines
@@ -59,7 +130,7 @@ namespace MultiLauncher {
                     // Check if it matches log pattern like [cli], [Core], [DL], [updater]
                     // Log lines usually have a space after the closing bracket if they are tags
                     size_t closingBracket = line.find(']');
-                    if (closingBracket != std::string::npos && closingBracket < 20) {
+                    if (closingBracket != std::string_view::npos && closingBracket < 20) {
                         bool onlyAlnum = true;
                         for (size_t i = 1; i < closingBracket; ++i) {
                             if (!isalnum((unsigned char)line[i]) && line[i] != '-') {
@@ -81,13 +152,13 @@ namespace MultiLauncher {
                     if (!isLogLine && (line[0] == '[' || line[0] == '{')) {
                         jsonStarted = true;
                         fullJson += line;
-                    } else if (!isLogLine && line.find("Logging in...") == std::string::npos) {
-                        Logger::instance().info("[Legendary Info] " + line);
+                    } else if (!isLogLine && line.find("Logging in...") == std::string_view::npos) {
+                        Logger::instance().info("[Legendary Info] " + std::string(line));
                     }
                 } else {
                     // Once JSON started, we append everything that doesn't look like a new log message
                     if (isLogLine) {
-                        Logger::instance().info("[Legendary Info] " + line);
+                        Logger::instance().info("[Legendary Info] " + std::string(line));
                     } else {
                         fullJson += line;
                     }
@@ -130,55 +201,140 @@ namespace MultiLauncher {
         }
 
         static void loginWithCode(const std::string& code, std::function<void()> onSuccess = nullptr) {
-            std::string cmd = getLegendaryBinary() + " auth --code " + code + " --yes";
             Logger::instance().info("Attempting to login to Epic Games with authorization code...");
-            ProcessRunner::runAsync(cmd, [onSuccess](int exitCode) {
+            ProcessRunner::spawnAsync({ getLegendaryBinary(), "auth", "--code", code, "--yes" }, [onSuccess](int exitCode) {
                 if (exitCode == 0) {
                     Logger::instance().info("Successfully logged into Epic Games!");
                     if (onSuccess) onSuccess();
                 } else {
                     Logger::instance().error("Epic Games login failed with code: " + std::to_string(exitCode));
                 }
-            });
+            }, nullptr, "", Executor::Interactive);
         }
 
         static void logout() {
-            std::string cmd = getLegendaryBinary() + " auth --delete --yes";
-            ProcessRunner::runAsync(cmd, [](int exitCode) {
+            ProcessRunner::spawnAsync({ getLegendaryBinary(), "auth", "--delete", "--yes" }, [](int exitCode) {
                 if (exitCode == 0) {
                     Logger::instance().info("Logged out from Epic Games.");
                 } else {
                     Logger::instance().error("Logout failed with code: " + std::to_string(exitCode));
                 }
-            });
+            }, nullptr, "", Executor::Interactive);
         }
 
-        static void installGame(Game& game, const std::string& basePath = "") {
-            std::string cmd = getLegendaryBinary() + " install " + game.getName() + " --skip-sdl --repair";
+        // Starts or resumes an install. legendary picks up its resume file, and
+        // --repair re-checks whatever an interrupted run left on disk.
+        // onFinished gets the game's resulting status (Idle, Paused or Error).
+        // Returns false if the game is already being installed. Installs
+        // started from the UI go through DownloadQueue.
+        static bool installGame(Game& game, const std::string& basePath = "",
+                                std::function<void(Game::GameStatus)> onFinished = nullptr) {
+            std::vector<std::string> args = { getLegendaryBinary(), "install", game.getName(), "--skip-sdl", "--repair" };
             if (!basePath.empty()) {
-                cmd += " --base-path \"" + basePath + "\"";
+                args.insert(args.end(), { "--base-path", basePath });
+            }
+            // sized for this machine and the target disk, fewer under a bandwidth cap
+            auto tuning = HardwareProbe::instance().tune(installDir(basePath));
+            int workers = tuning.maxWorkers;
+            if (int capped = TransferScheduler::instance().maxWorkers()) workers = std::min(workers, capped);
+            args.insert(args.end(), { "--max-workers", std::to_string(workers),
+                                      "--max-shared-memory", std::to_string(tuning.sharedMemoryMiB) });
+
+            // Registered before the child can finish, so the completion below
+            // always finds it; it may run right away if the task is refused
+            auto handle = std::make_shared<ProcessHandle>();
+            {
+                auto& active = installs();
+                std::lock_guard<std::mutex> lk(active.m);
+                auto it = active.handles.find(game.getName());
+                if (it != active.handles.end() && !it->second->finished()) {
+                    Logger::instance().info(game.getName() + " is already being installed");
+                    return false;
+                }
+                active.handles[game.getName()] = handle;
             }
 
             game.status = Game::GameStatus::Downloading;
+            game.setInstallProgress({});
+            HardwareProbe::instance().installStarted();
             
-            ProcessRunner::runAsync(cmd, [&](int code) {
-                if (code == 0) game.status = Game::GameStatus::Idle;
+            // `self` keeps the game alive if a scan drops it meanwhile
+            ProcessRunner::spawnAsync(std::move(args), [&game, self = game.weak_from_this().lock(), handle, onFinished](int code) {
+                {
+                    std::lock_guard<std::mutex> lk(installs().m);
+                    auto it = installs().handles.find(game.getName());
+                    if (it != installs().handles.end() && it->second == handle) installs().handles.erase(it);
+                }
+                HardwareProbe::instance().installFinished();
+                // legendary may exit cleanly after an interrupt
+                if (handle->cancelled()) game.status = Game::GameStatus::Paused;
+                else if (code == 0) game.status = Game::GameStatus::Idle;
                 else game.status = Game::GameStatus::Error;
-            }, [&](const std::string& line) {
-                std::regex progressRegex(R"(\[DL\]\s+(\d+)%\s+\|\s+([\d\.]+GB\s+/\s+[\d\.]+GB)\s+\|\s+([\d\. ]+\w+/s))");
-                std::smatch match;
-                if (std::regex_search(line, match, progressRegex)) {
-                    game.setProgress(std::stof(match[1].str()) / 100.0f);
-                    game.setETA(match[3].str());
+                if (onFinished) onFinished(game.status.load());
+            }, [&game, parser = std::make_shared<LegendaryProgressParser>()](std::string_view line) {
+                // progress lines arrive several times a second; the UI shows them
+                if (parser->feed(line)) {
+                    game.setInstallProgress(parser->progress());
+                    return;
                 }
-                Logger::instance().info("[Legendary] " + line);
+                Logger::instance().info("[Legendary] " + std::string(line));
+            }, "", Executor::Process, handle);
+            auto self = game.weak_from_this().lock();
+            if (self && !handle->finished()) {
+                TransferScheduler::instance().track(handle, [self]() {
+                    return self->getInstallProgress().downloadBytesPerSec;
+                });
+            }
+            return true;
+        }
+
+        // Interrupts the game's legendary install, escalating to a kill if it
+        // does not exit; the game ends up Paused and can be resumed with
+        // installGame. Returns immediately.
+        static void cancelInstall(Game& game) {
+            std::shared_ptr<ProcessHandle> handle;
+            {
+                std::lock_guard<std::mutex> lk(installs().m);
+                auto it = installs().handles.find(game.getName());
+                if (it != installs().handles.end()) handle = it->second;
+            }
+            if (!handle) {
+                // nothing running, e.g. a status left over from before a restart
+                game.status = Game::GameStatus::Paused;
+                return;
+            }
+            Logger::instance().info("Stopping install of " + game.getName());
+            handle->stopAsync([name = game.getName()](bool stopped) {
+                if (!stopped) Logger::instance().error("legendary did not exit after being killed (" + name + ")");
             });
         }
 
+        // Called on exit: interrupts every install so legendary writes its
+        // resume state instead of dying on a closed pipe later. Blocks.
+        static void stopInstalls(std::chrono::milliseconds grace) {
+            std::vector<std::shared_ptr<ProcessHandle> > running;
+            {
+                std::lock_guard<std::mutex> lk(installs().m);
+                for (auto& [_, handle] : installs().handles) running.push_back(handle);
+            }
+            // all at once, each escalating on its own
+            for (auto& handle : running) handle->stopAsync(nullptr, grace);
+            auto deadline = std::chrono::steady_clock::now() + grace * 3;
+            for (auto& handle : running) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                handle->wait(std::max(left, std::chrono::milliseconds(0)));
+            }
+        }
+
         static void launchGame(const std::string& appName) {
-            ProcessRunner::runAsync(getLegendaryBinary() + " launch " + appName, [](int code) {
+            LaunchMetrics::instance().begin(appName);
+            // legendary exits once the game is started, so this is not a long wait
+            ProcessRunner::spawnAsync({ getLegendaryBinary(), "launch", appName }, [](int code) {
                 Logger::instance().info("Legendary launch process completed with code: " + std::to_string(code));
-            });
+            }, [appName](std::string_view) {
+                // legendary's first line comes right before it starts the game
+                LaunchMetrics::instance().spawned(appName);
+            }, "", Executor::Interactive);
         }
     };
 }
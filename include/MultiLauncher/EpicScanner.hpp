@@ -11,6 +11,20 @@
 namespace MultiLauncher{
     class EpicScanner : public IScanner{
         public:
+            std::string name() const override { return "Epic"; }
+            Game::LauncherType launcher() const override { return Game::EPIC; }
+
+            std::vector<WatchTarget> watchTargets() const override {
+                std::vector<WatchTarget> targets;
+    #ifdef _WIN32
+                targets.push_back({ R"(C:\ProgramData\Epic\EpicGamesLauncher\Data\Manifests)", "", ".item" });
+    #endif
+                // legendary rewrites installed.json on every install/uninstall
+                std::filesystem::path legendaryDir = EpicProvider::configDir();
+                if (!legendaryDir.empty()) targets.push_back({ legendaryDir, "installed", ".json" });
+                return targets;
+            }
+
             std::vector<Game> scan(bool forceRefresh = false) override {
                 std::vector<Game> games;
     #ifdef _WIN32
@@ -0,0 +1,285 @@
+#pragma once
+#include "Logger.hpp"
+#include <array>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <type_traits>
+
+namespace MultiLauncher {
+
+    // Runs the launcher's background work on a bounded set of threads instead
+    // of one detached std::thread per job.
+    //
+    // Work is split into lanes, each with its own cap on concurrent tasks, so
+    // a burst in one (five "Refresh" clicks, fifty banner downloads) queues up
+    // there instead of starving the others or creating threads without bound.
+    // Lanes are isolated, not prioritized: each has its own workers, so
+    // Interactive work never waits behind another lane, and none waits
+    // behind it. stats() reports each lane's queue depth and wait; the
+    // Debug panel shows them.
+    // Inside a lane every worker owns a deque: tasks submitted from a worker
+    // go to its own deque (LIFO, cache-warm), others are dealt round-robin,
+    // and an idle worker steals the oldest task of a busy sibling. Workers
+    // start on demand up to the lane's cap.
+    //
+    // shutdown() drops queued tasks, asks running ones to stop through their
+    // std::stop_token and waits for them for a bounded time.
+    class Executor {
+    public:
+        enum Lane {
+            Interactive, // the user is waiting on it (launch, install start, banner decode)
+            Io,          // scanners, disk probes, banner downloads on Windows
+            Background,  // scan orchestration, rescans, startup loading, banner variants
+            Process,     // waits on a child process for its whole life (legendary, games on Windows)
+            Stop,        // ProcessHandle::stop escalations, kept out of the Process lane they wait on
+            LaneCount
+        };
+
+        struct LaneStats {
+            const char* name = "";
+            size_t workers = 0;
+            size_t maxWorkers = 0;
+            size_t queued = 0;
+            size_t running = 0;
+            size_t peakQueued = 0;
+            uint64_t completed = 0;
+            uint64_t dropped = 0;   // queued at shutdown
+            double avgWaitMs = 0;   // from submit to start
+        };
+
+        // Never destroyed: workers still blocked in a task at exit may touch it
+        static Executor& instance() {
+            static Executor* inst = new Executor();
+            return *inst;
+        }
+
+        // Takes a callable with no arguments or one std::stop_token. Returns
+        // false, without running it, once shutdown() has started.
+        template <typename F>
+        bool submit(Lane lane, F&& fn) {
+            if constexpr (std::is_invocable_v<F&, std::stop_token>) {
+                return enqueue(lane, Task(std::forward<F>(fn)));
+            } else {
+                return enqueue(lane, [f = std::forward<F>(fn)](std::stop_token) mutable { f(); });
+            }
+        }
+
+        // The lane's cap on concurrent tasks
+        static constexpr size_t maxWorkers(Lane lane) { return Config[lane].maxWorkers; }
+
+        LaneStats stats(Lane lane) const {
+            const LaneState& l = lanes_[lane];
+            std::lock_guard<std::mutex> lk(l.m);
+            return statsLocked(lane, l);
+        }
+
+        bool stopping() const { return stop_.stop_requested(); }
+
+        void shutdown(std::chrono::milliseconds timeout) {
+            if (!stop_.request_stop()) return;
+            for (auto& l : lanes_) {
+                std::lock_guard<std::mutex> lk(l.m);
+                for (size_t i = 0; i < l.started; ++i) {
+                    std::lock_guard<std::mutex> qlk(l.workers[i]->m);
+                    l.dropped += l.workers[i]->tasks.size();
+                    l.workers[i]->tasks.clear();
+                }
+                l.pending = 0;
+                l.cv.notify_all();
+            }
+
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            for (int lane = 0; lane < LaneCount; ++lane) {
+                LaneState& l = lanes_[lane];
+                std::unique_lock<std::mutex> lk(l.m);
+                l.idle.wait_until(lk, deadline, [&l]() { return l.running == 0; });
+                auto s = statsLocked(lane, l);
+                std::string msg = std::string("Executor ") + s.name + ": " + std::to_string(s.completed) +
+                    " tasks, avg wait " + std::to_string((int)s.avgWaitMs) + " ms, peak queue " +
+                    std::to_string(s.peakQueued);
+                if (s.dropped) msg += ", " + std::to_string(s.dropped) + " dropped";
+                if (s.running) msg += ", " + std::to_string(s.running) + " still running, detached";
+                Logger::instance().info(msg);
+                for (size_t i = 0; i < l.started; ++i) {
+                    Worker& w = *l.workers[i];
+                    if (!w.thread.joinable()) continue;
+                    if (w.busy) {
+                        w.thread.detach();
+                    } else {
+                        lk.unlock();
+                        w.thread.join();
+                        lk.lock();
+                    }
+                }
+            }
+        }
+
+    private:
+        using Task = std::function<void(std::stop_token)>;
+        using Clock = std::chrono::steady_clock;
+
+        struct LaneConfig {
+            const char* name;
+            size_t maxWorkers;
+        };
+        static constexpr LaneConfig Config[LaneCount] = {
+            { "interactive", 2 },
+            { "io", 4 },
+            { "background", 2 },
+            { "process", 8 },
+            { "stop", 8 },    // every Process child can be stopped at once
+        };
+
+        struct Entry {
+            Task fn;
+            Clock::time_point queuedAt;
+        };
+        struct Worker {
+            std::mutex m;
+            std::deque<Entry> tasks;
+            std::thread thread;
+            bool busy = false; // guarded by the lane mutex
+        };
+        struct LaneState {
+            mutable std::mutex m;
+            std::condition_variable cv;   // work arrived
+            std::condition_variable idle; // a task finished
+            std::vector<std::unique_ptr<Worker> > workers;
+            size_t started = 0;
+            size_t sleeping = 0;
+            size_t pending = 0;
+            size_t running = 0;
+            size_t peakQueued = 0;
+            size_t nextSlot = 0;
+            uint64_t completed = 0;
+            uint64_t dropped = 0;
+            double waitMs = 0;
+        };
+
+        std::array<LaneState, LaneCount> lanes_;
+        std::stop_source stop_;
+
+        // The worker running on this thread, if any, and its lane
+        static inline thread_local Worker* current_ = nullptr;
+        static inline thread_local int currentLane_ = -1;
+
+        Executor() {
+            for (int lane = 0; lane < LaneCount; ++lane) {
+                for (size_t i = 0; i < Config[lane].maxWorkers; ++i) {
+                    lanes_[lane].workers.push_back(std::make_unique<Worker>());
+                }
+            }
+        }
+
+        LaneStats statsLocked(int lane, const LaneState& l) const {
+            LaneStats s;
+            s.name = Config[lane].name;
+            s.workers = l.started;
+            s.maxWorkers = Config[lane].maxWorkers;
+            s.queued = l.pending;
+            s.running = l.running;
+            s.peakQueued = l.peakQueued;
+            s.completed = l.completed;
+            s.dropped = l.dropped;
+            s.avgWaitMs = l.completed ? l.waitMs / l.completed : 0;
+            return s;
+        }
+
+        bool enqueue(Lane lane, Task fn) {
+            LaneState& l = lanes_[lane];
+            std::lock_guard<std::mutex> lk(l.m);
+            // checked under the lane lock, so shutdown() cannot miss the task
+            if (stop_.stop_requested()) return false;
+            if (l.sleeping == 0 && l.started < l.workers.size()) {
+                size_t slot = l.started++;
+                l.workers[slot]->thread = std::thread([this, lane, slot]() { run(lane, slot); });
+            }
+            Worker* target = currentLane_ == lane ? current_ : l.workers[l.nextSlot++ % l.started].get();
+            {
+                std::lock_guard<std::mutex> qlk(target->m);
+                target->tasks.push_back({ std::move(fn), Clock::now() });
+            }
+            l.pending++;
+            l.peakQueued = std::max(l.peakQueued, l.pending);
+            l.cv.notify_one();
+            return true;
+        }
+
+        // Own deque from the back, then the oldest task of a sibling
+        bool take(LaneState& l, size_t self, size_t started, Entry& out) {
+            {
+                Worker& w = *l.workers[self];
+                std::lock_guard<std::mutex> qlk(w.m);
+                if (!w.tasks.empty()) {
+                    out = std::move(w.tasks.back());
+                    w.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (size_t i = 1; i < started; ++i) {
+                Worker& victim = *l.workers[(self + i) % started];
+                std::lock_guard<std::mutex> qlk(victim.m);
+                if (!victim.tasks.empty()) {
+                    out = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(int lane, size_t slot) {
+            LaneState& l = lanes_[lane];
+            current_ = l.workers[slot].get();
+            currentLane_ = lane;
+            std::unique_lock<std::mutex> lk(l.m);
+            while (true) {
+                Entry entry;
+                size_t started = l.started;
+                lk.unlock();
+                bool got = take(l, slot, started, entry);
+                lk.lock();
+                if (!got) {
+                    if (stop_.stop_requested()) return;
+                    // pending counts tasks not taken yet; one may sit in a deque
+                    // this worker did not see when it read `started`
+                    if (l.pending > 0 && l.started != started) continue;
+                    l.sleeping++;
+                    l.cv.wait(lk, [&]() { return l.pending > 0 || stop_.stop_requested(); });
+                    l.sleeping--;
+                    continue;
+                }
+                l.pending--;
+                l.running++;
+                current_->busy = true;
+                l.waitMs += std::chrono::duration<double, std::milli>(Clock::now() - entry.queuedAt).count();
+                lk.unlock();
+
+                try {
+                    entry.fn(stop_.get_token());
+                } catch (const std::exception& e) {
+                    Logger::instance().error(std::string("Unhandled exception in ") + Config[lane].name + " task: " + e.what());
+                } catch (...) {
+                    Logger::instance().error(std::string("Unhandled exception in ") + Config[lane].name + " task");
+                }
+                entry.fn = nullptr; // release captures before reporting completion
+
+                lk.lock();
+                current_->busy = false;
+                l.running--;
+                l.completed++;
+                l.idle.notify_all();
+            }
+        }
+    };
+
+}
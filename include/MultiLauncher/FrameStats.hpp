@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace MultiLauncher {
+
+    // Frame time distribution over a fixed wall-clock window. The mean says
+    // little about hitches; the standard deviation, p99 and max do.
+    class FrameStats {
+    public:
+        struct Summary {
+            size_t frames = 0;
+            double meanMs = 0;
+            double stddevMs = 0;
+            double p99Ms = 0;
+            double maxMs = 0;
+
+            std::string toString() const {
+                char buf[160];
+                std::snprintf(buf, sizeof(buf), "%zu frames, mean %.2f ms, stddev %.2f ms, p99 %.2f ms, max %.2f ms",
+                              frames, meanMs, stddevMs, p99Ms, maxMs);
+                return buf;
+            }
+        };
+
+        explicit FrameStats(std::chrono::milliseconds window = std::chrono::seconds(10)) : window_(window) {}
+
+        // Call once per frame. Returns true when a window just closed and
+        // last() holds its summary.
+        bool tick() {
+            auto now = std::chrono::steady_clock::now();
+            if (prev_ == std::chrono::steady_clock::time_point{}) {
+                prev_ = windowStart_ = now;
+                return false;
+            }
+            add(std::chrono::duration<double, std::milli>(now - prev_).count());
+            prev_ = now;
+            if (now - windowStart_ < window_) return false;
+            windowStart_ = now;
+            last_ = summarize();
+            samples_.clear();
+            return true;
+        }
+
+        // For callers that time frames themselves (benchmarks)
+        void add(double ms) { samples_.push_back(ms); }
+
+        Summary summarize() const {
+            Summary s;
+            s.frames = samples_.size();
+            if (samples_.empty()) return s;
+            double sum = 0;
+            for (double ms : samples_) sum += ms;
+            s.meanMs = sum / samples_.size();
+            double var = 0;
+            for (double ms : samples_) var += (ms - s.meanMs) * (ms - s.meanMs);
+            s.stddevMs = std::sqrt(var / samples_.size());
+            std::vector<double> sorted = samples_;
+            size_t p99 = std::min(sorted.size() - 1, sorted.size() * 99 / 100);
+            std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+            s.p99Ms = sorted[p99];
+            s.maxMs = *std::max_element(samples_.begin(), samples_.end());
+            return s;
+        }
+
+        const Summary& last() const { return last_; }
+
+    private:
+        std::chrono::milliseconds window_;
+        std::chrono::steady_clock::time_point prev_;
+        std::chrono::steady_clock::time_point windowStart_;
+        std::vector<double> samples_;
+        Summary last_;
+    };
+
+}
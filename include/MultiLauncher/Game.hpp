@@ -1,11 +1,15 @@
 #pragma once
 #include "Logger.hpp"
+#include "ProcessSnapshot.hpp"
+#include "SessionTracker.hpp"
+#include "InstallProgress.hpp"
 #include <string>
 #include <filesystem>
 #include <stdexcept>
 #include <utility>
 #include <atomic>
 #include <thread>
+#include <memory>
 #ifdef _WIN32
 #include <windows.h>
 #include <d3d11.h>
@@ -20,9 +24,13 @@ namespace MultiLauncher{
 #endif
         int width = 0;
         int height = 0;
+        size_t bytes = 0;        // all mip levels
+        bool downscaled = false; // a display-sized variant; the original is larger
     };
 
-    class Game{
+    // Owned through shared_ptr by GameCatalog; background work on a game holds
+    // a reference so the game outlives a scan that drops it
+    class Game : public std::enable_shared_from_this<Game>{
         public:
             enum LauncherType{
                 EPIC,
@@ -40,12 +48,15 @@ namespace MultiLauncher{
                 Running,
                 Downloading,
                 Installing,
-                Error
+                Error,
+                Paused, // install stopped by the user, resumable
+                Queued  // waiting in DownloadQueue for an install slot
             };
             enum BannerStatus{
                 BannerNotLoaded,
                 BannerDownloading,
                 BannerReadyToLoad,
+                BannerDecoding, // in TextureUploader
                 BannerLoaded,
                 BannerFailed
             };
@@ -58,18 +69,23 @@ namespace MultiLauncher{
             int steamAppId;
             mutable bool bannerLoaded;
             mutable BannerTexture banner;
-            float progress = 0.0f;
-            std::string eta = "";
+            // Render thread: the file the banner comes from and the panel width it is sized for
+            std::string bannerFile;
+            int bannerWidth = 0;
+            // Render thread: the game this one replaced, until its banner is taken over
+            std::shared_ptr<Game> replaced;
+            // Written by the legendary install thread, read every frame
+            SeqLock<InstallProgress> installProgress;
 
-            // Internal helper
-#ifdef _WIN32
-            bool LoadTextureFromFile(ID3D11Device* device, const wchar_t* filename, BannerTexture& out_banner) const;
-#else
-            bool LoadTextureFromFile(const char* filename, BannerTexture& out_banner) const;
-#endif
+            // Internal helpers
+            void decodeBanner(const std::string& file);
+            bool bannerShown(int displayWidth);
+            void adoptBanner();
+            void freeBanner();
 
         public:
             void updateStatus();
+            void updateStatus(const ProcessSnapshot& processes);
             bool isProcessRunning(const std::string& processName) const;
             std::atomic<GameStatus> status = GameStatus::Idle; 
             std::atomic<BannerStatus> bannerStatus = BannerStatus::BannerNotLoaded;
@@ -82,8 +98,7 @@ namespace MultiLauncher{
             // GETTERS
             const std::string& getName() const { return name; };
             const std::filesystem::path& getPath() const { return path; };
-            const float getProgress() const { return progress; };
-            const std::string getETA() const { return eta; };
+            InstallProgress getInstallProgress() const { return installProgress.load(); }
             const std::string getState() const{
                 switch(gameState){
                     case STOPPED: return "Not running";
@@ -92,28 +107,47 @@ namespace MultiLauncher{
                 }
                 return "Unknown";
             }
-            const std::string getLauncher() const {
+            // Returns a reference so per-frame sorting and lookups don't allocate
+            const std::string& getLauncher() const {
+                static const std::string epic = "Epic Games Store", steam = "Steam", gog = "GOG Galaxy", unknown = "Unknown";
                 switch (launcher){
-                    case EPIC: return "Epic Games Store";
-                    case STEAM: return "Steam";
-                    case GOG: return "GOG Galaxy";
+                    case EPIC: return epic;
+                    case STEAM: return steam;
+                    case GOG: return gog;
                 } 
-                return "Unknown";
+                return unknown;
             }
+            LauncherType getLauncherType() const { return launcher; }
             const std::string& getExeName() const {
                 return executableName;
             }
             void setState(State s) { gameState = s; }
-            void setProgress(float p) { progress = p; }
-            void setETA(const std::string& e) { eta = e; }
+            // A rescan found this game with other scanned fields (name, install
+            // path, executable, appid); they never change on a live Game, so
+            // GameCatalog builds a new one that takes over from `previous`:
+            // status and install progress now, the banner texture on the
+            // render thread. `previous` is not installing or running.
+            void inherit(const std::shared_ptr<Game>& previous) {
+                status.store(previous->status.load());
+                installProgress.store(previous->getInstallProgress());
+                replaced = previous;
+            }
+            void setInstallProgress(const InstallProgress& p) { installProgress.store(p); }
             void launchAsync();
+            // Records a finished play session and returns the game to Idle
+            void endSession(const LaunchSession& session);
 
+            // `displayWidth` is the panel's width in pixels; the smallest
+            // banner variant covering it is loaded, and a larger one once
+            // the panel outgrows it
 #ifdef _WIN32
-            bool loadBanner(ID3D11Device* device);
+            bool loadBanner(ID3D11Device* device, int displayWidth);
 #else
-            bool loadBanner();
+            bool loadBanner(int displayWidth);
 #endif
             const BannerTexture& getBanner() const { return banner; }
+            // Render thread: frees the banner texture; it loads again from disk when next shown
+            void releaseBanner();
             int getSteamAppId() const { return steamAppId; }
 
             Game(Game&& other) noexcept 
@@ -125,9 +159,11 @@ namespace MultiLauncher{
                   steamAppId(other.steamAppId),
                   bannerLoaded(other.bannerLoaded),
                   banner(other.banner),
-                  progress(other.progress),
-                  eta(std::move(other.eta))
+                  bannerFile(std::move(other.bannerFile)),
+                  bannerWidth(other.bannerWidth),
+                  replaced(std::move(other.replaced))
             {
+                installProgress.store(other.installProgress.load());
                 status.store(other.status.load());
                 bannerStatus.store(other.bannerStatus.load());
                 other.banner.srv = nullptr;
@@ -147,6 +183,9 @@ namespace MultiLauncher{
                     steamAppId = other.steamAppId;
                     bannerLoaded = other.bannerLoaded;
                     banner = other.banner;
+                    bannerFile = std::move(other.bannerFile);
+                    bannerWidth = other.bannerWidth;
+                    replaced = std::move(other.replaced);
                     bannerStatus.store(other.bannerStatus.load());
                     
                     other.banner.srv = nullptr;
@@ -0,0 +1,218 @@
+#pragma once
+#include "Game.hpp"
+#include "Logger.hpp"
+#include <vector>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <algorithm>
+#include <cstdint>
+
+namespace MultiLauncher {
+
+    // Stable identity of a game across scans and restarts (see GameCatalog::idOf)
+    using GameId = uint64_t;
+
+    // Owns the game list and keeps hash indexes over it, so merging a scan
+    // result is O(found) and lookups are O(1). Not synchronized: GameManager
+    // guards it with gamesMutex.
+    class GameCatalog {
+    public:
+        struct MergeResult {
+            size_t added = 0;
+            size_t removed = 0;
+            size_t updated = 0;
+        };
+
+        // Lowercase alphanumerics only, so "DOOM: Eternal" and "Doom Eternal" match
+        static std::string normalizeName(std::string_view name) {
+            std::string out;
+            out.reserve(name.size());
+            for (char c : name) {
+                if (c >= 'A' && c <= 'Z') out += (char)(c - 'A' + 'a');
+                else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || (unsigned char)c >= 0x80) out += c;
+            }
+            return out;
+        }
+
+        // The launcher's own id: Steam appid or GOG gameId when the scanner
+        // provided one, otherwise the normalized name (Epic titles).
+        static std::string nativeId(const Game& game) {
+            if (game.getSteamAppId() > 0) return std::to_string(game.getSteamAppId());
+            return normalizeName(game.getName());
+        }
+
+        static GameId makeId(Game::LauncherType launcher, std::string_view nativeId) {
+            // FNV-1a 64
+            uint64_t h = 14695981039346656037ull;
+            auto mix = [&h](unsigned char c) {
+                h ^= c;
+                h *= 1099511628211ull;
+            };
+            mix((unsigned char)launcher);
+            for (char c : nativeId) mix((unsigned char)c);
+            return h;
+        }
+
+        static GameId idOf(const Game& game) {
+            return makeId(game.getLauncherType(), nativeId(game));
+        }
+
+        // Adds the games that are not known yet and replaces the ones whose
+        // scanned fields changed (an install that moved, entries from
+        // library.idx) with a new Game that inherits their runtime state.
+        // Fields of a live Game are read without the lock, so they are never
+        // rewritten; a game that is busy keeps its old fields until settle()
+        // finds it quiet. When `authoritative` is set, games of that launcher
+        // missing from `found` are removed unless they are busy (running,
+        // downloading, or fetching a banner).
+        MergeResult merge(std::vector<Game>&& found, std::optional<Game::LauncherType> authoritative = std::nullopt) {
+            MergeResult result;
+            std::vector<GameId> ids;
+            ids.reserve(found.size());
+            for (const auto& g : found) ids.push_back(idOf(g));
+
+            if (authoritative && !found.empty()) {
+                std::unordered_set<GameId> present(ids.begin(), ids.end());
+                size_t before = games_.size();
+                bool any = false;
+                for (const auto& existing : games_) {
+                    if (removable(*existing, *authoritative, present)) {
+                        any = true;
+                        break;
+                    }
+                }
+                if (any) {
+                    std::erase_if(games_, [&](const std::shared_ptr<Game>& existing) {
+                        return removable(*existing, *authoritative, present);
+                    });
+                    result.removed = before - games_.size();
+                    reindex();
+                }
+            }
+
+            games_.reserve(games_.size() + found.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                auto known = byId_.find(ids[i]);
+                if (known != byId_.end()) {
+                    if (sameScan(*known->second, found[i])) pending_.erase(ids[i]);
+                    else pending_.insert_or_assign(ids[i], std::move(found[i]));
+                    continue;
+                }
+                games_.emplace_back(std::make_shared<Game>(std::move(found[i])));
+                index(ids[i], games_.back().get());
+                result.added++;
+            }
+            result.updated = settle();
+            return result;
+        }
+
+        // Replaces the games with a pending rescan that are quiet now; returns
+        // how many. GameManager calls it after every process check.
+        size_t settle() {
+            size_t replaced = 0;
+            for (auto it = pending_.begin(); it != pending_.end();) {
+                auto known = byId_.find(it->first);
+                if (known == byId_.end()) {
+                    // removed meanwhile
+                    it = pending_.erase(it);
+                    continue;
+                }
+                if (!quiet(*known->second)) {
+                    ++it;
+                    continue;
+                }
+                auto slot = std::find_if(games_.begin(), games_.end(), [&](const std::shared_ptr<Game>& g) {
+                    return g.get() == known->second;
+                });
+                auto fresh = std::make_shared<Game>(std::move(it->second));
+                fresh->inherit(*slot);
+                if (fresh->getName() != (*slot)->getName()) {
+                    Logger::instance().info((*slot)->getName() + " is now listed as " + fresh->getName());
+                }
+                *slot = std::move(fresh);
+                it = pending_.erase(it);
+                replaced++;
+            }
+            // a renamed game moves in the name index
+            if (replaced) reindex();
+            return replaced;
+        }
+
+        Game* find(GameId id) const {
+            auto it = byId_.find(id);
+            return it != byId_.end() ? it->second : nullptr;
+        }
+
+        Game* findNative(Game::LauncherType launcher, std::string_view nativeId) const {
+            return find(makeId(launcher, nativeId));
+        }
+
+        Game* findSteamApp(int appId) const {
+            auto it = bySteamAppId_.find(appId);
+            return it != bySteamAppId_.end() ? it->second : nullptr;
+        }
+
+        // The same title can be installed from several launchers
+        std::vector<Game*> findByName(std::string_view name) const {
+            std::vector<Game*> out;
+            auto range = byName_.equal_range(normalizeName(name));
+            for (auto it = range.first; it != range.second; ++it) out.push_back(it->second);
+            return out;
+        }
+
+        size_t size() const { return games_.size(); }
+        std::vector<std::shared_ptr<Game> >& games() { return games_; }
+        const std::vector<std::shared_ptr<Game> >& games() const { return games_; }
+
+    private:
+        std::vector<std::shared_ptr<Game> > games_;
+        std::unordered_map<GameId, Game*> byId_;
+        std::unordered_map<int, Game*> bySteamAppId_;
+        std::unordered_multimap<std::string, Game*> byName_;
+        // What the last scan found for known games whose scanned fields differ
+        std::unordered_map<GameId, Game> pending_;
+
+        static bool sameScan(const Game& a, const Game& b) {
+            return a.getName() == b.getName() && a.getPath() == b.getPath() &&
+                   a.getExeName() == b.getExeName() && a.getSteamAppId() == b.getSteamAppId();
+        }
+
+        // Nothing in flight holds the game: no install, launch or session,
+        // and no banner download or upload
+        static bool quiet(const Game& game) {
+            auto status = game.status.load();
+            auto banner = game.bannerStatus.load();
+            return status != Game::GameStatus::Launching && status != Game::GameStatus::Running &&
+                   status != Game::GameStatus::Downloading && status != Game::GameStatus::Installing &&
+                   banner != Game::BannerDownloading && banner != Game::BannerDecoding;
+        }
+
+        static bool removable(const Game& game, Game::LauncherType launcher, const std::unordered_set<GameId>& present) {
+            return game.getLauncherType() == launcher &&
+                   game.status.load() == Game::GameStatus::Idle &&
+                   game.bannerStatus.load() != Game::BannerDownloading &&
+                   !present.count(idOf(game));
+        }
+
+        void index(GameId id, Game* game) {
+            byId_.emplace(id, game);
+            if (game->getLauncherType() == Game::STEAM && game->getSteamAppId() > 0) {
+                bySteamAppId_.emplace(game->getSteamAppId(), game);
+            }
+            byName_.emplace(normalizeName(game->getName()), game);
+        }
+
+        void reindex() {
+            byId_.clear();
+            bySteamAppId_.clear();
+            byName_.clear();
+            byId_.reserve(games_.size());
+            for (const auto& g : games_) index(idOf(*g), g.get());
+        }
+    };
+
+}
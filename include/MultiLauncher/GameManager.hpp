@@ -4,66 +4,405 @@
 #include "Game.hpp"
 #include <memory>
 #include "Logger.hpp"
+#include "LibraryIndex.hpp"
+#include "GameCatalog.hpp"
+#include "LibraryWatcher.hpp"
+#include "ProcessTracker.hpp"
+#include "SessionTracker.hpp"
+#include "PlaytimeManager.hpp"
+#include "ResourceMonitor.hpp"
+#include "LaunchMetrics.hpp"
+#include "Executor.hpp"
+#include "TransferScheduler.hpp"
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <optional>
+#include <tuple>
+#include <map>
+#include <unordered_set>
+#include <algorithm>
+#include <functional>
 
 namespace MultiLauncher{
+    // Immutable view of the library for the render thread, published by
+    // GameManager after every process check and merge. Holding one keeps its
+    // games alive even if a scan removes them from the catalog meanwhile.
+    struct StatusSnapshot{
+        struct Entry{
+            std::shared_ptr<Game> game;
+            Game::GameStatus status;
+        };
+        std::vector<Entry> games; // catalog order
+        uint64_t version = 0;
+    };
+
     class GameManager{
         public:
+            // How long scanAll waits for a single scanner. A scanner that misses it
+            // keeps running and still merges its games once it is done.
+            static constexpr std::chrono::seconds ScanDeadline{30};
+            // Process checks when nothing else triggers one. Exits of running games
+            // are always seen through pidfds; starts only with the proc connector.
+            static constexpr std::chrono::milliseconds LaunchPoll{250};
+            // While a download runs, so its end shows up without a click
+            static constexpr std::chrono::milliseconds BusyPoll{1000};
+            static constexpr std::chrono::milliseconds IdlePoll{5000};
+            static constexpr std::chrono::milliseconds EventPoll{30000};
+            // How long the destructor waits for scans still running
+            static constexpr std::chrono::seconds ShutdownWait{5};
+
+            GameManager() = default;
+            // Executor tasks capture `this`: stop producing them, then wait for
+            // the ones already queued or running. A scanner blocked on legendary
+            // is not waited out; the process is exiting at that point anyway.
+            ~GameManager(){
+                tracker.stop();
+                watcher.stop();
+                auto state = tasks;
+                std::unique_lock<std::mutex> lk(state->m);
+                if(!state->done.wait_for(lk, ShutdownWait, [&]{ return state->inFlight == 0; })){
+                    Logger::instance().error(std::to_string(state->inFlight) + " library tasks still running at exit");
+                }
+            }
+
             void addScanner(std::unique_ptr<IScanner> scanner){
-                scanners.push_back(std::move(scanner));
+                auto slot = std::make_unique<ScannerSlot>();
+                slot->scanner = std::move(scanner);
+                scanners.push_back(std::move(slot));
             }
-            void update(){
-                std::lock_guard<std::mutex> lock(gamesMutex);
-                for(auto& game : games){
-                    game->updateStatus();
+            // Re-checks every game against the process table. Returns how long the
+            // tracker may wait before the next check if no event arrives.
+            std::chrono::milliseconds update(){
+                // one walk of the process table for all games, outside the lock
+                ProcessSnapshot processes = ProcessSnapshot::capture();
+                std::vector<int> runningPids;
+                std::unordered_set<std::string> exeNames;
+                std::vector<std::tuple<std::string, bool, int> > running; // name, Steam, processes
+                std::vector<std::string> stopped;
+                std::vector<std::pair<std::string, std::string> > started; // name, executable
+                std::map<std::string, std::vector<int> > telemetry; // name -> executable pids
+                bool launching = false;
+                bool busy = false;
+                size_t replaced = 0;
+                {
+                    std::lock_guard<std::mutex> lock(gamesMutex);
+                    exeNames.reserve(catalog.size());
+                    for(auto& game : catalog.games()){
+                        auto before = game->status.load();
+                        game->updateStatus(processes);
+                        auto status = game->status.load();
+                        if(status == Game::GameStatus::Launching) launching = true;
+                        if(status == Game::GameStatus::Downloading || status == Game::GameStatus::Installing) busy = true;
+                        if(status == Game::GameStatus::Running){
+                            auto pids = processes.pids(game->getExeName());
+                            runningPids.insert(runningPids.end(), pids.begin(), pids.end());
+                            running.emplace_back(game->getName(), game->getLauncherType() == Game::STEAM, (int)pids.size());
+                            telemetry.emplace(game->getName(), std::move(pids));
+                            if(before != Game::GameStatus::Running) started.emplace_back(game->getName(), game->getExeName());
+                        }else if(before == Game::GameStatus::Running){
+                            stopped.push_back(game->getName());
+                        }
+                        exeNames.insert(ProcessSnapshot::lower(game->getExeName()));
+                    }
+                    // rescans that waited for a game to stop or finish installing
+                    replaced = catalog.settle();
+                    publishLocked();
                 }
+                if(replaced && libraryListener) libraryListener();
+                // Sessions of games whose process tree we don't own (Steam client,
+                // legendary, started outside the launcher)
+                auto& sessions = SessionTracker::instance();
+                for(const auto& [name, steam, count] : running){
+                    // by value: the game may be gone from the catalog when this runs
+                    sessions.detectedRunning(name, count, [steam](const LaunchSession& s){
+                        PlaytimeManager::instance().recordSession(s, steam);
+                    });
+                }
+                for(const auto& name : stopped) sessions.detectedStopped(name);
+                for(const auto& [name, exe] : started) LaunchMetrics::instance().detected(name, exe);
+                ResourceMonitor::instance().watch(std::move(telemetry));
+                // background transfers drop to the playing budget while anything runs
+                TransferScheduler::instance().setPlaying(!running.empty());
+                tracker.watchPids(runningPids);
+                tracker.watchNames(std::move(exeNames));
+                if(launching || LaunchMetrics::instance().awaitingDetection()) return LaunchPoll;
+                if(busy) return BusyPoll;
+                return tracker.eventDriven() ? EventPoll : IdlePoll;
+            }
+            // Starts keeping Game::status current on a background thread; replaces
+            // calling update() on a timer
+            void trackProcesses(){
+                tracker.start([this](){ return update(); });
+            }
+            // Call after changing a game's status from the UI (launch, install,
+            // cancel): the snapshot shows it on the next frame, and a launch
+            // switches to fast polling right away.
+            void refreshStatus(){
+                {
+                    std::lock_guard<std::mutex> lock(gamesMutex);
+                    publishLocked();
+                }
+                tracker.wake();
+            }
+            // The latest published library, without taking gamesMutex. Never null.
+            std::shared_ptr<const StatusSnapshot> snapshot() const {
+                return published.load(std::memory_order_acquire);
             }
+            // Runs every scanner concurrently and merges each scanner's games as
+            // soon as it finishes, so fast scanners (Steam) show up before slow
+            // ones (Epic via legendary) are done.
             void scanAll(bool forceRefresh = false){
-                for(auto& scanner : scanners){
-                    try{
-                        auto found = scanner->scan(forceRefresh);
-                        std::lock_guard<std::mutex> lock(gamesMutex);
-                        for(auto& g : found){
-                            // Check for duplicates
-                            bool exists = false;
-                            for(const auto& existing : games){
-                                if(existing->getName() == g.getName() &&
-                                   existing->getLauncher() == g.getLauncher()){
-                                    exists = true;
-                                    // Optionally update existing game info if needed
-                                    break;
-                                }
-                            }
-                            if(!exists){
-                                games.emplace_back(std::make_unique<Game>(std::move(g)));
+                scanLaunchers(forceRefresh, {});
+            }
+            // Same as scanAll, restricted to the given launchers (all if empty)
+            void scanLaunchers(bool forceRefresh, const std::vector<Game::LauncherType>& only){
+                auto state = std::make_shared<ScanState>();
+                std::vector<ScannerSlot*> started;
+                for(auto& slot : scanners){
+                    if(!only.empty() && std::find(only.begin(), only.end(), slot->scanner->launcher()) == only.end()){
+                        continue;
+                    }
+                    if(slot->busy.exchange(true)){
+                        // The running scan may already have read the old state
+                        slot->rescan = true;
+                        Logger::instance().info(slot->scanner->name() + " scan already in progress, queued another pass");
+                        continue;
+                    }
+                    started.push_back(slot.get());
+                }
+                if(started.empty()) return;
+
+                state->pending = started.size();
+                state->done.assign(started.size(), false);
+                scansInFlight += (int)started.size();
+
+                for(size_t i = 0; i < started.size(); ++i){
+                    ScannerSlot* slot = started[i];
+                    bool queued = Executor::instance().submit(Executor::Io, [this, ref = taskRef(), slot, state, i, forceRefresh](){
+                        const std::string scannerName = slot->scanner->name();
+                        auto begin = std::chrono::steady_clock::now();
+                        size_t found = 0, added = 0;
+                        bool failed = false;
+                        do{
+                            try{
+                                auto result = slot->scanner->scan(forceRefresh);
+                                found = result.size();
+                                added += merge(std::move(result), slot->scanner->launcher());
+                                failed = false;
+                            }catch(const std::exception& e){
+                                failed = true;
+                                Logger::instance().error(scannerName + " scanner error: " + e.what());
                             }
+                        }while(slot->rescan.exchange(false));
+                        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - begin).count();
+
+                        bool late = false;
+                        {
+                            std::lock_guard<std::mutex> lk(state->m);
+                            late = state->timedOut;
+                            state->done[i] = true;
+                            state->pending--;
+                        }
+                        std::string msg = scannerName + " scan " + (failed ? "failed" : "finished") +
+                            " in " + std::to_string(ms) + " ms (" + std::to_string(found) + " found, " +
+                            std::to_string(added) + " new)";
+                        if(late) msg += " after missing the deadline";
+                        Logger::instance().info(msg);
+                        // scanAll already wrote the index without this scanner's games
+                        if(late) saveIndex();
+                        // library folders may have been added or removed
+                        watcher.setTargets(slot->scanner->launcher(), slot->scanner->watchTargets());
+
+                        slot->busy = false;
+                        scansInFlight--;
+                        state->cv.notify_all();
+                    });
+                    if(!queued){
+                        // shutting down
+                        std::lock_guard<std::mutex> lk(state->m);
+                        state->done[i] = true;
+                        state->pending--;
+                        slot->busy = false;
+                        scansInFlight--;
+                    }
+                }
+
+                std::unique_lock<std::mutex> lk(state->m);
+                // Sliced so an application shutdown does not wait out the deadline
+                auto deadline = std::chrono::steady_clock::now() + ScanDeadline;
+                while(state->pending != 0 && !Executor::instance().stopping() &&
+                      std::chrono::steady_clock::now() < deadline){
+                    state->cv.wait_for(lk, std::chrono::milliseconds(100), [&]{ return state->pending == 0; });
+                }
+                if(Executor::instance().stopping()) return;
+                if(state->pending != 0){
+                    state->timedOut = true;
+                    for(size_t i = 0; i < started.size(); ++i){
+                        if(!state->done[i]){
+                            Logger::instance().error(started[i]->scanner->name() + " scan timed out after " +
+                                std::to_string(ScanDeadline.count()) + " s, its games will be added when it finishes");
                         }
-                    }catch(const std::exception& e){
-                        Logger::instance().error(std::string("Scanner error: ") + e.what());
                     }
                 }
+                lk.unlock();
+                saveIndex();
+            }
+
+            // Populates the list from the on-disk index written by the last scan.
+            // Meant to run before the first frame; scanners reconcile it afterwards.
+            void loadIndex(){
+                auto begin = std::chrono::steady_clock::now();
+                auto cached = LibraryIndex::load();
+                if(cached.empty()) return;
+                size_t added = merge(std::move(cached));
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+                Logger::instance().info("Loaded " + std::to_string(added) + " games from library index in " +
+                    std::to_string(ms) + " ms");
+            }
+
+            void saveIndex() const {
+                std::lock_guard<std::mutex> lock(gamesMutex);
+                LibraryIndex::save(catalog.games());
+            }
+
+            // Null if there is none. A rescan may replace a game's object, so
+            // code that outlives a frame keeps the id and resolves it again.
+            std::shared_ptr<Game> findGame(GameId id) const {
+                std::lock_guard<std::mutex> lock(gamesMutex);
+                Game* game = catalog.find(id);
+                return game ? game->weak_from_this().lock() : nullptr;
+            }
+            // Called, without gamesMutex held, after games were added, removed
+            // or replaced. Set it before the first scan.
+            void onLibraryChanged(std::function<void()> listener){
+                libraryListener = std::move(listener);
+            }
+
+            // Starts live updates: installs/uninstalls picked up by the watcher
+            // rescan only the affected launchers, without forcing a legendary
+            // network refresh.
+            void watchLibraries(){
+                bool started = watcher.start([this](const std::vector<LibraryWatcher::Change>& changes){
+                    std::vector<Game::LauncherType> launchers;
+                    for(const auto& c : changes){
+                        static const char* kinds[] = { "added", "modified", "removed", "unknown" };
+                        Logger::instance().info("Library change: " +
+                            (c.path.empty() ? std::string("events lost") : c.path.filename().string()) +
+                            " " + kinds[c.kind]);
+                        if(std::find(launchers.begin(), launchers.end(), c.launcher) == launchers.end()){
+                            launchers.push_back(c.launcher);
+                        }
+                    }
+                    Executor::instance().submit(Executor::Background, [this, ref = taskRef(), launchers](){
+                        scanLaunchers(false, launchers);
+                    });
+                });
+                if(started) Logger::instance().info("Watching game libraries for changes");
             }
 
             void scanAsync(bool forceRefresh = false) {
-                std::thread([this, forceRefresh](){
+                Executor::instance().submit(Executor::Background, [this, ref = taskRef(), forceRefresh](){
                     scanAll(forceRefresh);
-                }).detach();
+                });
+            }
+            bool isScanning() const { return scansInFlight.load() > 0; }
+            // Hold lockGames() while using these; the render thread reads snapshot() instead
+            std::vector<std::shared_ptr<Game> >& getGames() {
+                return catalog.games();
             }
-            // mutable access
-            std::vector<std::unique_ptr<Game> >& getGames() {
-                return games;
+            const std::vector<std::shared_ptr<Game> >& getGames() const {
+                return catalog.games();
             }
-            // const access - Note: GUI should ideally use a copy or lock if games can be added mid-frame
-            const std::vector<std::unique_ptr<Game> >& getGames() const {
-                return games;
+            // O(1) lookups by id, Steam appid or name; hold lockGames() while using it
+            const GameCatalog& getCatalog() const {
+                return catalog;
             }
-            
+
             std::unique_lock<std::mutex> lockGames() const {
                 return std::unique_lock<std::mutex>(gamesMutex);
             }
         private:
-            std::vector<std::unique_ptr<IScanner> > scanners;
-            std::vector<std::unique_ptr<Game> >games;
+            struct ScannerSlot{
+                std::unique_ptr<IScanner> scanner;
+                std::atomic<bool> busy = false;
+                std::atomic<bool> rescan = false;
+            };
+            // Shared between scanAll and its workers; outlives scanAll on timeout
+            struct ScanState{
+                std::mutex m;
+                std::condition_variable cv;
+                size_t pending = 0;
+                std::vector<bool> done;
+                bool timedOut = false;
+            };
+
+            // Returns the number of games that were not known yet. When the result
+            // comes from a scanner, games of its launcher it no longer reports are
+            // dropped (this is how stale index entries disappear). An empty result
+            // is treated as inconclusive, e.g. legendary being offline.
+            size_t merge(std::vector<Game>&& found, std::optional<Game::LauncherType> authoritative = std::nullopt){
+                GameCatalog::MergeResult result;
+                {
+                    std::lock_guard<std::mutex> lock(gamesMutex);
+                    result = catalog.merge(std::move(found), authoritative);
+                    if(result.added || result.removed || result.updated) publishLocked();
+                }
+                if(result.removed){
+                    Logger::instance().info("Removed " + std::to_string(result.removed) +
+                        " games that are no longer installed");
+                }
+                if(result.updated){
+                    Logger::instance().info("Updated " + std::to_string(result.updated) +
+                        " games whose install changed");
+                }
+                if((result.added || result.removed || result.updated) && libraryListener) libraryListener();
+                return result.added;
+            }
+
+            // Held by every executor task that uses `this`; ~GameManager waits for all of them.
+            // The count outlives the manager, so a task still running after ShutdownWait can drop it.
+            std::shared_ptr<void> taskRef(){
+                {
+                    std::lock_guard<std::mutex> lk(tasks->m);
+                    tasks->inFlight++;
+                }
+                return std::shared_ptr<void>(nullptr, [state = tasks](void*){
+                    std::lock_guard<std::mutex> lk(state->m);
+                    if(--state->inFlight == 0) state->done.notify_all();
+                });
+            }
+
+            // Copies the catalog into a new snapshot; gamesMutex must be held
+            void publishLocked(){
+                auto next = std::make_shared<StatusSnapshot>();
+                next->games.reserve(catalog.size());
+                for(const auto& game : catalog.games()){
+                    next->games.push_back({ game, game->status.load() });
+                }
+                next->version = ++publishedVersion;
+                published.store(std::move(next), std::memory_order_release);
+            }
+
+            std::vector<std::unique_ptr<ScannerSlot> > scanners;
+            GameCatalog catalog;
             mutable std::mutex gamesMutex;
+            std::atomic<std::shared_ptr<const StatusSnapshot> > published{ std::make_shared<const StatusSnapshot>() };
+            uint64_t publishedVersion = 0;
+            std::atomic<int> scansInFlight = 0;
+            std::function<void()> libraryListener;
+            struct TaskCount {
+                std::mutex m;
+                std::condition_variable done;
+                size_t inFlight = 0;
+            };
+            std::shared_ptr<TaskCount> tasks = std::make_shared<TaskCount>();
+            // Last members: stopped first on destruction, before anything their callbacks use
+            ProcessTracker tracker;
+            LibraryWatcher watcher;
     };
 } // namespace MultiLauncher
\ No newline at end of file
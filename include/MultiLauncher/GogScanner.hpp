@@ -4,6 +4,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include "Logger.hpp"
 #include "../JSON/json.hpp"
 
 using json = nlohmann::json;
@@ -11,39 +12,49 @@ using json = nlohmann::json;
 namespace MultiLauncher{
     class GogScanner : public IScanner{
         public:
-            std::vector<Game> scan(bool forceRefresh = false) override {
-                std::vector<Game> games;
-                // TODO:
-                // we have to scan C:Program Files (x86)\GOG Galaxy\Games\
-                // and find goggame-XXXXXXX.info
 #ifdef _WIN32
-                std::filesystem::path manifestDir = R"(C:\Program Files (x86)\GOG Galaxy\Games)";
+            GogScanner() : gamesDir(R"(C:\Program Files (x86)\GOG Galaxy\Games)") {}
 #else
-                return games;  // there is no official GOG launcher for linux
+            GogScanner() = default; // there is no official GOG launcher for linux
 #endif
-                if(!exists(manifestDir) ){
+            // Scans another Games directory (benchmarks, custom Galaxy library)
+            explicit GogScanner(std::filesystem::path dir) : gamesDir(std::move(dir)) {}
+
+            std::string name() const override { return "GOG"; }
+            Game::LauncherType launcher() const override { return Game::GOG; }
+
+            std::vector<WatchTarget> watchTargets() const override {
+                // a new game shows up as a new directory under Games
+                if(gamesDir.empty()) return {};
+                return { { gamesDir, "", "" } };
+            }
+
+            // Every game is a directory under Games with goggame-<id>.info at its
+            // root. Only that level is listed: walking the whole tree recursively
+            // meant visiting every installed game file.
+            std::vector<Game> scan(bool forceRefresh = false) override {
+                std::vector<Game> games;
+                std::error_code ec;
+                if(gamesDir.empty() || !std::filesystem::exists(gamesDir, ec)){
                     return games;
                 }
                 std::vector<std::filesystem::path> gogGames;
-                std::filesystem::path gogFile = "";
-                for(const auto& entry : std::filesystem::recursive_directory_iterator(manifestDir)){
-                    if(entry.path().extension() == ".info"){
+                for(const auto& dir : std::filesystem::directory_iterator(gamesDir, ec)){
+                    if(!dir.is_directory(ec)) continue;
+                    for(const auto& entry : std::filesystem::directory_iterator(dir.path(), ec)){
                         std::string filename = entry.path().filename().string();
-                        if(filename.substr(0, 8) == "goggame-"){ //goggame-
-                            Logger::instance().info("Found gog info file");
-                            gogFile = entry;
-                            gogGames.push_back(entry);
+                        if(filename.rfind("goggame-", 0) == 0 && entry.path().extension() == ".info"){
+                            gogGames.push_back(entry.path());
                         }
                     }
                 }
 
-                try{
-                    for(auto i : gogGames){
-                        std::ifstream file;
-                        file.open(i); // otwieranie pliku
+                for(const auto& i : gogGames){
+                    try{
+                        std::ifstream file(i);
                         json data = json::parse(file);
                         std::string name = data["name"]; // name of the game
-                        std::filesystem::path dirPath = R"(C:\Program Files (x86)\GOG Galaxy\Games\)" / std::filesystem::path(name);
+                        std::filesystem::path dirPath = i.parent_path();
                         std::filesystem::path exe = data["playTasks"][0]["path"]; // executable name
                         std::filesystem::path exePath = dirPath / exe; // full path to the executable
                         std::string id = data["gameId"]; // gameId
@@ -55,18 +66,16 @@ namespace MultiLauncher{
                             exe.filename().string(),
                             gameId
                         );
-
-                        file.close();
+                    }catch(const std::exception& e){
+                        // one broken .info file should not hide the other games
+                        Logger::instance().error("Could not read " + i.filename().string() + ": " + e.what());
                     }
-                }catch(json::parse_error &e){
-                    std::cout << "There was a parse error: " << e.what() << std::endl;
-                }catch(std::ios_base::failure &e){
-                    std::cout << "Error while opening a file: " << e.what() << std::endl;
-                }
-                for(int i = 0; i < games.size(); i++){
-                    std::cout << games[i].getName() << std::endl;
                 }
+                Logger::instance().info("Total GOG games found: " + std::to_string(games.size()));
                 return games;
             }
+
+        private:
+            std::filesystem::path gamesDir;
     };
 } // namespace MultiLauncher
\ No newline at end of file
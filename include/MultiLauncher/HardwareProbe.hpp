@@ -0,0 +1,348 @@
+#pragma once
+#include "Logger.hpp"
+#include "Executor.hpp"
+#include "../external/JSON/json.hpp"
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#endif
+
+namespace MultiLauncher {
+
+    // Picks legendary's --max-workers and --max-shared-memory for the machine
+    // and the volume an install goes to. legendary's defaults (twice the
+    // cores, at most 16 workers, 1 GiB of shared memory) overrun a slow disk:
+    // the workers fill the shared memory faster than the single writer
+    // drains it. They also starve small machines of RAM.
+    //
+    // A volume's sequential write speed comes from a short direct-I/O write
+    // of a scratch file, once per mount point; results are cached in
+    // hardware_probe.json and measured again after MaxAge. A probe only runs
+    // while no install is writing (DownloadQueue runs it before its first
+    // install), and a result an install overlapped is not kept.
+    class HardwareProbe {
+    public:
+        struct Tuning {
+            int maxWorkers = 0;
+            int sharedMemoryMiB = 0;
+        };
+
+        static constexpr uint64_t ProbeBytes = 256ull << 20;
+        static constexpr uint64_t ProbeBlock = 8ull << 20;
+        // The probe stops early on slow disks
+        static constexpr std::chrono::milliseconds ProbeTime{1500};
+        static constexpr std::chrono::hours MaxAge{24 * 30};
+        // Write speed one download worker keeps busy
+        static constexpr double WorkerMiBPerSec = 16;
+        // Shared memory per worker, within [MinSharedMiB, MaxSharedMiB] and at
+        // most a quarter of the free RAM
+        static constexpr int SharedMiBPerWorker = 64;
+        static constexpr int MinSharedMiB = 256;
+        static constexpr int MaxSharedMiB = 2048;
+
+        static HardwareProbe& instance() {
+            static HardwareProbe inst;
+            return inst;
+        }
+
+        static int cores() {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        static uint64_t freeRamBytes() {
+#ifdef _WIN32
+            MEMORYSTATUSEX status = {};
+            status.dwLength = sizeof(status);
+            return GlobalMemoryStatusEx(&status) ? status.ullAvailPhys : 0;
+#else
+            // MemAvailable counts reclaimable cache, unlike sysinfo's freeram
+            FILE* f = std::fopen("/proc/meminfo", "r");
+            if (!f) return 0;
+            char line[256];
+            unsigned long long kib = 0;
+            while (std::fgets(line, sizeof(line), f)) {
+                if (std::sscanf(line, "MemAvailable: %llu kB", &kib) == 1) break;
+            }
+            std::fclose(f);
+            return kib * 1024;
+#endif
+        }
+
+        // The mount point (Linux) or volume root (Windows) holding `path`,
+        // which need not exist yet
+        static std::filesystem::path mountPoint(const std::filesystem::path& path) {
+            std::filesystem::path p = existingAncestor(path);
+#ifdef _WIN32
+            wchar_t volume[MAX_PATH];
+            if (GetVolumePathNameW(p.wstring().c_str(), volume, MAX_PATH)) return volume;
+            return p.root_path();
+#else
+            struct stat st;
+            if (stat(p.c_str(), &st) != 0) return p;
+            while (p.has_parent_path() && p.parent_path() != p) {
+                struct stat parent;
+                if (stat(p.parent_path().c_str(), &parent) != 0 || parent.st_dev != st.st_dev) break;
+                p = p.parent_path();
+            }
+            return p;
+#endif
+        }
+
+        // Cached write speed of the volume holding `path`, if measured
+        std::optional<double> writeMiBPerSec(const std::filesystem::path& path) {
+            std::string mount = mountPoint(path).string();
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = volumes_.find(mount);
+            if (it == volumes_.end() || std::chrono::system_clock::now() - it->second.measuredAt > MaxAge) {
+                return std::nullopt;
+            }
+            return it->second.writeMiBPerSec;
+        }
+
+        // An install started or finished writing; probes wait for none to run
+        void installStarted() {
+            std::lock_guard<std::mutex> lk(m_);
+            activeInstalls_++;
+            installsStarted_++;
+        }
+        void installFinished() {
+            std::lock_guard<std::mutex> lk(m_);
+            activeInstalls_--;
+        }
+
+        // Measures the volume holding `path` in the background unless it is
+        // cached, an install is running, or it already failed this session.
+        // True if a probe is running; `done` then runs when it ends, on the
+        // executor, whatever the outcome.
+        bool probeAsync(const std::filesystem::path& path, std::function<void()> done = nullptr) {
+            if (writeMiBPerSec(path)) return false;
+            std::string mount = mountPoint(path).string();
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (activeInstalls_ > 0 || failed_.count(mount)) return false;
+                auto [it, created] = probing_.try_emplace(mount);
+                if (done) it->second.push_back(std::move(done));
+                if (!created) return true;
+            }
+            bool queued = Executor::instance().submit(Executor::Io, [this, path, mount]() {
+                measure(path);
+                std::vector<std::function<void()> > waiting;
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    waiting = std::move(probing_[mount]);
+                    probing_.erase(mount);
+                }
+                for (auto& fn : waiting) fn();
+            });
+            if (!queued) {
+                std::lock_guard<std::mutex> lk(m_);
+                probing_.erase(mount);
+                return false;
+            }
+            return true;
+        }
+
+        // Writes a scratch file next to `path` and records the speed for its
+        // volume. Blocks for up to ProbeTime plus the final flush.
+        std::optional<double> measure(const std::filesystem::path& path) {
+            std::filesystem::path dir = existingAncestor(path);
+            std::string mount = mountPoint(dir).string();
+            std::error_code ec;
+            auto space = std::filesystem::space(dir, ec);
+            if (ec || space.available < ProbeBytes * 4) {
+                Logger::instance().info("Not measuring write speed of " + mount + ": not enough free space");
+                std::lock_guard<std::mutex> lk(m_);
+                failed_.insert(mount);
+                return std::nullopt;
+            }
+            uint64_t epoch;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (activeInstalls_ > 0) {
+                    Logger::instance().info("Not measuring write speed of " + mount + ": an install is running");
+                    return std::nullopt;
+                }
+                epoch = installsStarted_;
+            }
+            std::filesystem::path file = dir / ".multilauncher_probe.tmp";
+            bool direct = false;
+            auto mibPerSec = writeProbe(file, direct);
+            std::filesystem::remove(file, ec);
+            if (!mibPerSec) {
+                Logger::instance().error("Could not measure write speed of " + mount);
+                std::lock_guard<std::mutex> lk(m_);
+                failed_.insert(mount);
+                return std::nullopt;
+            }
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (installsStarted_ != epoch) {
+                    // measured under contention; would skew tuning for MaxAge
+                    Logger::instance().info("Discarded write speed of " + mount + ": an install started during the probe");
+                    return std::nullopt;
+                }
+            }
+            char msg[160];
+            std::snprintf(msg, sizeof(msg), "Sequential write speed of %s: %.0f MiB/s%s", mount.c_str(), *mibPerSec,
+                          direct ? " (direct I/O)" : " (buffered, direct I/O unsupported)");
+            Logger::instance().info(msg);
+            std::lock_guard<std::mutex> lk(m_);
+            volumes_[mount] = { *mibPerSec, std::chrono::system_clock::now() };
+            save();
+            return mibPerSec;
+        }
+
+        // Never blocks: a volume that was not measured yet (installs were
+        // already running when it was queued) is tuned on cores and RAM only
+        Tuning tune(const std::filesystem::path& installDir) {
+            int n = cores();
+            uint64_t ram = freeRamBytes();
+            auto disk = writeMiBPerSec(installDir);
+
+            Tuning t;
+            t.maxWorkers = std::clamp(n * 2, 2, 16);
+            if (disk) t.maxWorkers = std::clamp((int)(*disk / WorkerMiBPerSec + 0.5), 2, t.maxWorkers);
+            int ramCap = ram ? (int)(ram / 4 >> 20) : MaxSharedMiB;
+            t.sharedMemoryMiB = std::clamp(t.maxWorkers * SharedMiBPerWorker, MinSharedMiB, MaxSharedMiB);
+            t.sharedMemoryMiB = std::max(MinSharedMiB, std::min(t.sharedMemoryMiB, ramCap));
+
+            char msg[256];
+            char diskText[48] = "disk not measured yet";
+            if (disk) std::snprintf(diskText, sizeof(diskText), "disk %.0f MiB/s", *disk);
+            std::snprintf(msg, sizeof(msg), "Install tuning for %s: %d cores, %.1f GiB free RAM, %s -> --max-workers %d --max-shared-memory %d",
+                          mountPoint(installDir).string().c_str(), n, ram / (1024.0 * 1024.0 * 1024.0), diskText,
+                          t.maxWorkers, t.sharedMemoryMiB);
+            Logger::instance().info(msg);
+            return t;
+        }
+
+    private:
+        HardwareProbe() { load(); }
+
+        struct Volume {
+            double writeMiBPerSec = 0;
+            std::chrono::system_clock::time_point measuredAt;
+        };
+
+        std::mutex m_;
+        std::map<std::string, Volume> volumes_; // by mount point
+        // mount point -> callbacks waiting for its probe
+        std::map<std::string, std::vector<std::function<void()> > > probing_;
+        std::set<std::string> failed_; // could not be measured; not probed again until restart
+        int activeInstalls_ = 0;
+        uint64_t installsStarted_ = 0;
+
+        static std::filesystem::path existingAncestor(const std::filesystem::path& path) {
+            std::error_code ec;
+            std::filesystem::path p = std::filesystem::absolute(path, ec);
+            while (!p.empty() && !std::filesystem::exists(p, ec) && p.has_parent_path() && p.parent_path() != p) {
+                p = p.parent_path();
+            }
+            return p;
+        }
+
+        // MiB/s over the blocks written and the final flush. Direct I/O keeps
+        // the page cache from hiding the disk; filesystems without it (tmpfs)
+        // fall back to buffered writes.
+        static std::optional<double> writeProbe(const std::filesystem::path& file, bool& direct) {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t written = 0;
+#ifdef _WIN32
+            HANDLE h = CreateFileW(file.wstring().c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                   FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH, NULL);
+            if (h == INVALID_HANDLE_VALUE) return std::nullopt;
+            direct = true;
+            // unbuffered writes need sector-aligned memory; pages are
+            void* buf = VirtualAlloc(NULL, ProbeBlock, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+            if (!buf) {
+                CloseHandle(h);
+                return std::nullopt;
+            }
+            std::memset(buf, 0x5a, ProbeBlock);
+            start = std::chrono::steady_clock::now();
+            while (written < ProbeBytes && std::chrono::steady_clock::now() - start < ProbeTime) {
+                DWORD n = 0;
+                if (!WriteFile(h, buf, (DWORD)ProbeBlock, &n, NULL) || n != ProbeBlock) break;
+                written += n;
+            }
+            FlushFileBuffers(h);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            VirtualFree(buf, 0, MEM_RELEASE);
+            CloseHandle(h);
+#else
+            int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0600);
+            direct = fd >= 0;
+            if (fd < 0) fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            if (fd < 0) return std::nullopt;
+            // O_DIRECT needs buffers aligned to the logical block size
+            void* buf = nullptr;
+            if (posix_memalign(&buf, 4096, ProbeBlock) != 0) {
+                ::close(fd);
+                return std::nullopt;
+            }
+            std::memset(buf, 0x5a, ProbeBlock);
+            start = std::chrono::steady_clock::now();
+            while (written < ProbeBytes && std::chrono::steady_clock::now() - start < ProbeTime) {
+                ssize_t n = ::write(fd, buf, ProbeBlock);
+                if (n <= 0) break;
+                written += (uint64_t)n;
+            }
+            fdatasync(fd);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            std::free(buf);
+            ::close(fd);
+#endif
+            double seconds = std::chrono::duration<double>(elapsed).count();
+            if (written == 0 || seconds <= 0) return std::nullopt;
+            return (double)written / (1024.0 * 1024.0) / seconds;
+        }
+
+        void load() {
+            if (!std::filesystem::exists("hardware_probe.json")) return;
+            try {
+                std::ifstream i("hardware_probe.json");
+                nlohmann::json j;
+                i >> j;
+                for (auto& [mount, v] : j.items()) {
+                    Volume volume;
+                    volume.writeMiBPerSec = v.value("writeMiBPerSec", 0.0);
+                    volume.measuredAt = std::chrono::system_clock::time_point(std::chrono::seconds(v.value("measuredAt", (int64_t)0)));
+                    if (volume.writeMiBPerSec > 0) volumes_[mount] = volume;
+                }
+            } catch (...) {}
+        }
+
+        // m_ must be held
+        void save() const {
+            try {
+                nlohmann::json j = nlohmann::json::object();
+                for (const auto& [mount, volume] : volumes_) {
+                    auto at = std::chrono::duration_cast<std::chrono::seconds>(volume.measuredAt.time_since_epoch()).count();
+                    j[mount] = { { "writeMiBPerSec", volume.writeMiBPerSec }, { "measuredAt", (int64_t)at } };
+                }
+                std::ofstream o("hardware_probe.json");
+                o << j.dump(2);
+            } catch (...) {}
+        }
+    };
+
+}
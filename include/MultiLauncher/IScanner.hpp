@@ -1,11 +1,27 @@
 #pragma once
 #include <vector>
+#include <string>
+#include <filesystem>
 #include "Game.hpp"
 
 namespace MultiLauncher{
+    // A directory whose direct children affect a scanner's result. Only files
+    // starting with prefix and ending with suffix count (empty matches all).
+    struct WatchTarget{
+        std::filesystem::path dir;
+        std::string prefix;
+        std::string suffix;
+    };
+
     class IScanner{
         public:
             virtual std::vector<Game> scan(bool forceRefresh = false) = 0;
+            // Human readable name used in logs ("Steam", "Epic", ...)
+            virtual std::string name() const = 0;
+            // Launcher whose games this scanner is authoritative for
+            virtual Game::LauncherType launcher() const = 0;
+            // Directories to watch for live updates, refreshed after every scan
+            virtual std::vector<WatchTarget> watchTargets() const { return {}; }
             virtual ~IScanner() = default;
     };
 } // namespace MultiLauncher
\ No newline at end of file
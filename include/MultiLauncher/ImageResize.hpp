@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace MultiLauncher {
+
+    // Downscaling for RGBA8 images. The loops run over whole rows of plain
+    // integers with no branches inside, so the compiler vectorizes them.
+    class ImageResize {
+    public:
+        // Area-averaging (box) filter: every output pixel is the average of
+        // the source area it covers, edge pixels weighted by how much of them
+        // is covered. Separable: rows first, then columns.
+        static void box(const uint8_t* src, int srcW, int srcH, uint8_t* dst, int dstW, int dstH) {
+            auto cols = weights(srcW, dstW);
+            auto rows = weights(srcH, dstH);
+
+            // horizontal: srcH rows of dstW pixels
+            std::vector<uint8_t> tmp((size_t)dstW * srcH * 4);
+            for (int y = 0; y < srcH; ++y) {
+                const uint8_t* in = src + (size_t)y * srcW * 4;
+                uint8_t* out = tmp.data() + (size_t)y * dstW * 4;
+                for (int x = 0; x < dstW; ++x) {
+                    const Span& s = cols[x];
+                    uint32_t acc[4] = { Half, Half, Half, Half };
+                    for (int i = 0; i < s.count; ++i) {
+                        const uint8_t* p = in + (size_t)(s.first + i) * 4;
+                        uint32_t w = s.weight[i];
+                        acc[0] += w * p[0];
+                        acc[1] += w * p[1];
+                        acc[2] += w * p[2];
+                        acc[3] += w * p[3];
+                    }
+                    for (int c = 0; c < 4; ++c) out[x * 4 + c] = (uint8_t)(acc[c] >> Shift);
+                }
+            }
+
+            // vertical: whole rows at a time
+            size_t rowBytes = (size_t)dstW * 4;
+            std::vector<uint32_t> acc(rowBytes);
+            for (int y = 0; y < dstH; ++y) {
+                const Span& s = rows[y];
+                std::fill(acc.begin(), acc.end(), Half);
+                for (int i = 0; i < s.count; ++i) {
+                    const uint8_t* in = tmp.data() + (size_t)(s.first + i) * rowBytes;
+                    uint32_t w = s.weight[i];
+                    for (size_t j = 0; j < rowBytes; ++j) acc[j] += w * in[j];
+                }
+                uint8_t* out = dst + (size_t)y * rowBytes;
+                for (size_t j = 0; j < rowBytes; ++j) out[j] = (uint8_t)(acc[j] >> Shift);
+            }
+        }
+
+        // Next mip level: each output pixel averages a 2x2 block. The output
+        // is max(1, srcW / 2) by max(1, srcH / 2); an odd last row or column
+        // is dropped, as GL does.
+        static void halve(const uint8_t* src, int srcW, int srcH, uint8_t* dst) {
+            int dstW = std::max(1, srcW / 2);
+            int dstH = std::max(1, srcH / 2);
+            size_t srcRow = (size_t)srcW * 4;
+            for (int y = 0; y < dstH; ++y) {
+                const uint8_t* a = src + (size_t)std::min(2 * y, srcH - 1) * srcRow;
+                const uint8_t* b = src + (size_t)std::min(2 * y + 1, srcH - 1) * srcRow;
+                uint8_t* out = dst + (size_t)y * dstW * 4;
+                if (srcW == 1) {
+                    for (int c = 0; c < 4; ++c) out[c] = (uint8_t)((a[c] + b[c] + 1) >> 1);
+                    continue;
+                }
+                for (int x = 0; x < dstW; ++x) {
+                    for (int c = 0; c < 4; ++c) {
+                        int i = x * 8 + c;
+                        out[x * 4 + c] = (uint8_t)((a[i] + a[i + 4] + b[i] + b[i + 4] + 2) >> 2);
+                    }
+                }
+            }
+        }
+
+    private:
+        // Weights are fixed point with Shift fractional bits and sum to 1
+        static constexpr int Shift = 14;
+        static constexpr uint32_t One = 1u << Shift;
+        static constexpr uint32_t Half = One >> 1;
+
+        struct Span {
+            int first = 0;
+            int count = 0;
+            std::vector<uint32_t> weight;
+        };
+
+        // For each output index, the source indices it covers and their weights
+        static std::vector<Span> weights(int srcLen, int dstLen) {
+            std::vector<Span> spans(dstLen);
+            double scale = (double)srcLen / dstLen;
+            for (int d = 0; d < dstLen; ++d) {
+                double a = d * scale;
+                double b = std::min((double)srcLen, (d + 1) * scale);
+                Span& s = spans[d];
+                s.first = std::min((int)a, srcLen - 1);
+                int last = std::clamp((int)(b - 1e-9), s.first, srcLen - 1);
+                s.count = last - s.first + 1;
+                uint32_t sum = 0;
+                size_t largest = 0;
+                for (int i = s.first; i <= last; ++i) {
+                    double cover = std::min(b, (double)i + 1) - std::max(a, (double)i);
+                    uint32_t w = (uint32_t)(cover / (b - a) * One + 0.5);
+                    s.weight.push_back(w);
+                    sum += w;
+                    if (w > s.weight[largest]) largest = s.weight.size() - 1;
+                }
+                // rounding leftovers go to the biggest weight
+                s.weight[largest] += One - sum;
+            }
+            return spans;
+        }
+    };
+
+}
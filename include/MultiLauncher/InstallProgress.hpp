@@ -0,0 +1,236 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace MultiLauncher {
+
+    // One snapshot of a legendary install. Fields legendary has not reported
+    // yet stay at their defaults.
+    struct InstallProgress {
+        float percent = 0;
+        uint64_t downloadedBytes = 0;
+        uint64_t totalBytes = 0;         // download size, from legendary's summary
+        float downloadBytesPerSec = 0;   // raw, before decompression
+        float diskBytesPerSec = 0;       // written
+        int etaSeconds = -1;             // -1: unknown
+        int activeTasks = 0;             // legendary's download workers with a task
+
+        float fraction() const { return percent / 100.0f; }
+
+        // "1.2 / 4.5 GiB, 12.3 MiB/s down, 20.1 MiB/s disk, ETA 00:03:12"
+        std::string toString() const {
+            auto mib = [](double bytes) { return bytes / (1024.0 * 1024.0); };
+            char buf[192];
+            int n = 0;
+            if (totalBytes) {
+                n = std::snprintf(buf, sizeof(buf), "%.1f / %.1f GiB", mib((double)downloadedBytes) / 1024.0,
+                                  mib((double)totalBytes) / 1024.0);
+            } else {
+                n = std::snprintf(buf, sizeof(buf), "%.1f GiB", mib((double)downloadedBytes) / 1024.0);
+            }
+            n += std::snprintf(buf + n, sizeof(buf) - n, ", %.1f MiB/s down, %.1f MiB/s disk",
+                               mib(downloadBytesPerSec), mib(diskBytesPerSec));
+            if (etaSeconds >= 0) {
+                std::snprintf(buf + n, sizeof(buf) - n, ", ETA %02d:%02d:%02d", etaSeconds / 3600,
+                              etaSeconds / 60 % 60, etaSeconds % 60);
+            }
+            return buf;
+        }
+    };
+
+    // Publishes a small trivially copyable value from one writer to any
+    // number of readers without a lock: readers retry while a write is in
+    // progress. The value is kept in atomic words so a torn read is never
+    // undefined behaviour, only discarded.
+    template <typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+    public:
+        SeqLock() { store(T{}); }
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        // One writer at a time
+        void store(const T& value) {
+            std::array<uint64_t, Words> words = {};
+            std::memcpy(words.data(), &value, sizeof(T));
+            uint64_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < Words; ++i) words_[i].store(words[i], std::memory_order_relaxed);
+            seq_.store(seq + 2, std::memory_order_release);
+        }
+
+        T load() const {
+            std::array<uint64_t, Words> words;
+            while (true) {
+                uint64_t before = seq_.load(std::memory_order_acquire);
+                if (before & 1) continue;
+                for (size_t i = 0; i < Words; ++i) words[i] = words_[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq_.load(std::memory_order_relaxed) == before) break;
+            }
+            T value;
+            std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr size_t Words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        std::atomic<uint64_t> seq_ = 0;
+        std::array<std::atomic<uint64_t>, Words> words_;
+    };
+
+    // Reads `legendary install` output one line at a time and accumulates an
+    // InstallProgress. Understands the download manager's status block
+    //
+    //   [DLManager] INFO: = Progress: 12.34% (123/1000), Running for 00:01:23, ETA: 00:12:34
+    //   [DLManager] INFO:  - Downloaded: 1234.56 MiB, Written: 2345.67 MiB
+    //   [DLManager] INFO:  - Cache usage: 123.45 MiB, active tasks: 16
+    //   [DLManager] INFO:  + Download	- 45.67 MiB/s (raw) / 89.01 MiB/s (decompressed)
+    //   [DLManager] INFO:  + Disk	- 89.01 MiB/s (write) / 0.00 MiB/s (read)
+    //
+    // (also with the shorter [DLM] tag), the "Download size:" line printed
+    // before the download starts, and the compact
+    //
+    //   [DL] 42% | 1.2GB / 4.5GB | 10.5 MB/s
+    //
+    // form. Works on string_views with from_chars: no allocation per line.
+    class LegendaryProgressParser {
+    public:
+        // True if the line changed the progress
+        bool feed(std::string_view line) {
+            if (line.starts_with("[DL]")) return parseCompact(line.substr(4));
+            std::string_view rest;
+            if (after(line, "Download size:", rest)) return parseSize(rest, progress_.totalBytes);
+            if (line.starts_with("[DLM")) return parseManager(line);
+            return false;
+        }
+
+        const InstallProgress& progress() const { return progress_; }
+
+    private:
+        InstallProgress progress_;
+
+        bool parseManager(std::string_view line) {
+            std::string_view rest;
+            if (after(line, "Progress:", rest)) {
+                double pct;
+                if (!parseNumber(rest, pct)) return false;
+                progress_.percent = (float)pct;
+                std::string_view eta;
+                if (after(rest, "ETA:", eta)) progress_.etaSeconds = parseClock(eta);
+                return true;
+            }
+            if (after(line, "Downloaded:", rest)) return parseSize(rest, progress_.downloadedBytes);
+            if (after(line, "active tasks:", rest)) {
+                double tasks;
+                if (!parseNumber(rest, tasks)) return false;
+                progress_.activeTasks = (int)tasks;
+                return true;
+            }
+            if (after(line, "+ Download", rest)) return parseRate(rest, progress_.downloadBytesPerSec);
+            if (after(line, "+ Disk", rest)) return parseRate(rest, progress_.diskBytesPerSec);
+            return false;
+        }
+
+        // 42% | 1.2GB / 4.5GB | 10.5 MB/s [| ETA 00:01:02]
+        bool parseCompact(std::string_view rest) {
+            double pct;
+            if (!parseNumber(rest, pct)) return false;
+            progress_.percent = (float)pct;
+            std::string_view field;
+            if (after(rest, "|", field)) {
+                parseSize(field, progress_.downloadedBytes);
+                if (after(field, "/", field)) parseSize(field, progress_.totalBytes);
+            }
+            if (after(rest, "|", field) && after(field, "|", field)) parseRate(field, progress_.downloadBytesPerSec);
+            if (after(rest, "ETA", field)) {
+                skip(field, ": ");
+                progress_.etaSeconds = parseClock(field);
+            }
+            return true;
+        }
+
+        // Sets `rest` to what follows the first `token` in `s`
+        static bool after(std::string_view s, std::string_view token, std::string_view& rest) {
+            size_t at = s.find(token);
+            if (at == std::string_view::npos) return false;
+            rest = s.substr(at + token.size());
+            return true;
+        }
+
+        static void skip(std::string_view& s, std::string_view chars) {
+            size_t start = s.find_first_not_of(chars);
+            s.remove_prefix(start == std::string_view::npos ? s.size() : start);
+        }
+
+        // Leading whitespace, then a number; advances past it
+        static bool parseNumber(std::string_view& s, double& out) {
+            skip(s, " \t-");
+            auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+            if (ec != std::errc()) return false;
+            s.remove_prefix(end - s.data());
+            return true;
+        }
+
+        // Binary (KiB) and decimal (KB) units; legendary uses the former
+        static double unitScale(std::string_view& s) {
+            skip(s, " ");
+            static constexpr struct { std::string_view unit; double scale; } units[] = {
+                { "TiB", 1099511627776.0 }, { "GiB", 1073741824.0 }, { "MiB", 1048576.0 }, { "KiB", 1024.0 },
+                { "TB", 1e12 }, { "GB", 1e9 }, { "MB", 1e6 }, { "KB", 1e3 }, { "kB", 1e3 }, { "B", 1.0 },
+            };
+            for (const auto& u : units) {
+                if (s.starts_with(u.unit)) {
+                    s.remove_prefix(u.unit.size());
+                    return u.scale;
+                }
+            }
+            return 0;
+        }
+
+        static bool parseSize(std::string_view& s, uint64_t& out) {
+            double value;
+            if (!parseNumber(s, value)) return false;
+            double scale = unitScale(s);
+            if (scale == 0) return false;
+            out = (uint64_t)(value * scale);
+            return true;
+        }
+
+        static bool parseRate(std::string_view& s, float& out) {
+            double value;
+            if (!parseNumber(s, value)) return false;
+            double scale = unitScale(s);
+            if (scale == 0 || !s.starts_with("/s")) return false;
+            out = (float)(value * scale);
+            return true;
+        }
+
+        // hh:mm:ss; -1 if it is not one
+        static int parseClock(std::string_view s) {
+            skip(s, " ");
+            int parts[3];
+            for (int i = 0; i < 3; ++i) {
+                auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), parts[i]);
+                if (ec != std::errc()) return -1;
+                s.remove_prefix(end - s.data());
+                if (i < 2) {
+                    if (!s.starts_with(':')) return -1;
+                    s.remove_prefix(1);
+                }
+            }
+            return parts[0] * 3600 + parts[1] * 60 + parts[2];
+        }
+    };
+
+}
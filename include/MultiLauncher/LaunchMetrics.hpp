@@ -0,0 +1,456 @@
+#pragma once
+#include "../external/JSON/json.hpp"
+#include "Logger.hpp"
+#include "ProcessSnapshot.hpp"
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <map>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <bit>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#endif
+
+namespace MultiLauncher {
+
+    // Log-linear histogram of milliseconds (HDR style): 16 linear sub-buckets
+    // per power of two, so any recorded value is off by at most 1/16 (~6%),
+    // in a fixed 272 counters up to ~17 minutes.
+    class LatencyHistogram {
+    public:
+        static constexpr int SubBuckets = 16;
+        static constexpr uint64_t MaxMs = (1ull << 20) - 1;
+        static constexpr int Buckets = 272; // index(MaxMs) + 1
+
+        static int index(uint64_t ms) {
+            if (ms > MaxMs) ms = MaxMs;
+            if (ms < SubBuckets) return (int)ms;
+            int msb = std::bit_width(ms) - 1;
+            int shift = msb - 4;
+            return SubBuckets * shift + (int)(ms >> shift);
+        }
+
+        static uint64_t lowerBound(int i) {
+            if (i < SubBuckets) return (uint64_t)i;
+            int shift = i / SubBuckets - 1;
+            return (uint64_t)(i - SubBuckets * shift) << shift;
+        }
+
+        void record(uint64_t ms) {
+            counts_[index(ms)]++;
+            total_++;
+        }
+
+        uint64_t count() const { return total_; }
+
+        // Middle of the bucket holding the p-th percentile (0-100)
+        uint64_t percentile(double p) const {
+            if (total_ == 0) return 0;
+            uint64_t rank = std::max<uint64_t>(1, (uint64_t)(p / 100.0 * total_ + 0.5));
+            uint64_t seen = 0;
+            for (int i = 0; i < Buckets; ++i) {
+                seen += counts_[i];
+                if (seen >= rank) {
+                    uint64_t lo = lowerBound(i);
+                    uint64_t hi = i + 1 < Buckets ? lowerBound(i + 1) - 1 : MaxMs;
+                    return lo + (hi - lo) / 2;
+                }
+            }
+            return MaxMs;
+        }
+
+        // Sparse: {"<bucket>": count}
+        nlohmann::json toJson() const {
+            nlohmann::json j = nlohmann::json::object();
+            for (int i = 0; i < Buckets; ++i) {
+                if (counts_[i]) j[std::to_string(i)] = counts_[i];
+            }
+            return j;
+        }
+
+        static LatencyHistogram fromJson(const nlohmann::json& j) {
+            LatencyHistogram h;
+            for (auto& [key, value] : j.items()) {
+                int i = std::atoi(key.c_str());
+                if (i < 0 || i >= Buckets || !value.is_number_unsigned()) continue;
+                h.counts_[i] = value.get<uint32_t>();
+                h.total_ += h.counts_[i];
+            }
+            return h;
+        }
+
+    private:
+        std::array<uint32_t, Buckets> counts_ = {};
+        uint64_t total_ = 0;
+    };
+
+    // How long launches take, per game, measured from the click:
+    //  - Spawn:  the launch process exists (our fork, ShellExecute, or the
+    //            first output of `legendary launch`)
+    //  - Detect: the game's executable shows up in a process check
+    //  - Window: the executable owns a top-level window (X11 _NET_CLIENT_LIST
+    //            or EnumWindows); not observed on pure Wayland
+    // Histograms survive restarts in launch_metrics.json.
+    class LaunchMetrics {
+    public:
+        enum Stage { Spawn, Detect, Window, StageCount };
+        static constexpr const char* StageNames[StageCount] = { "spawn", "detect", "window" };
+
+        // A launch that never gets further is forgotten after this
+        static constexpr std::chrono::minutes PendingTimeout{5};
+        static constexpr std::chrono::seconds WindowTimeout{180};
+        static constexpr std::chrono::milliseconds WindowPoll{100};
+
+        static LaunchMetrics& instance() {
+            static LaunchMetrics inst;
+            return inst;
+        }
+
+        // Stamps the click; call before anything else of the launch runs
+        void begin(const std::string& game) {
+            std::lock_guard<std::mutex> lk(m_);
+            Pending& p = pending_[game];
+            p = {};
+            p.start = Clock::now();
+        }
+
+        void spawned(const std::string& game) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = pending_.find(game);
+            if (it == pending_.end() || it->second.spawned) return;
+            it->second.spawned = true;
+            recordLocked(game, Spawn, it->second.start);
+        }
+
+        // From GameManager::update when the game's executable starts running.
+        // Ignored unless a launch of this game is pending.
+        void detected(const std::string& game, const std::string& exeName) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = pending_.find(game);
+            if (it == pending_.end()) return;
+            Pending p = it->second;
+            pending_.erase(it);
+            if (Clock::now() - p.start > PendingTimeout) return;
+            recordLocked(game, Detect, p.start);
+            windows_.push_back({ game, ProcessSnapshot::lower(exeName), p.start });
+            if (!windowThread_.joinable()) windowThread_ = std::thread([this]() { windowLoop(); });
+            cv_.notify_all();
+        }
+
+        // True while a launch waits for its executable; GameManager polls fast
+        // meanwhile, since Epic launches never enter GameStatus::Launching
+        bool awaitingDetection() {
+            std::lock_guard<std::mutex> lk(m_);
+            auto now = Clock::now();
+            std::erase_if(pending_, [&](const auto& p) { return now - p.second.start > PendingTimeout; });
+            return !pending_.empty();
+        }
+
+        // {p50, p95} in ms, if the stage was ever recorded for the game
+        std::optional<std::pair<uint64_t, uint64_t> > percentiles(const std::string& game, Stage stage) const {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = games_.find(game);
+            if (it == games_.end() || it->second[stage].count() == 0) return std::nullopt;
+            return std::make_pair(it->second[stage].percentile(50), it->second[stage].percentile(95));
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Pending {
+            Clock::time_point start;
+            bool spawned = false;
+        };
+        struct WindowWait {
+            std::string game;
+            std::string exe; // lowercased basename
+            Clock::time_point start;
+        };
+
+        mutable std::mutex m_;
+        std::condition_variable cv_;
+        std::map<std::string, std::array<LatencyHistogram, StageCount> > games_;
+        std::map<std::string, Pending> pending_;
+        std::vector<WindowWait> windows_;
+        std::thread windowThread_;
+        bool stopping_ = false;
+
+        LaunchMetrics() { load(); }
+        ~LaunchMetrics() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            if (windowThread_.joinable()) windowThread_.join();
+        }
+
+        void recordLocked(const std::string& game, Stage stage, Clock::time_point start) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+            games_[game][stage].record((uint64_t)std::max<long long>(0, ms));
+            Logger::instance().info("Launch " + game + ": " + StageNames[stage] + " after " + std::to_string(ms) + " ms");
+            save();
+        }
+
+        void load() {
+            if (!std::filesystem::exists("launch_metrics.json")) return;
+            try {
+                std::ifstream i("launch_metrics.json");
+                nlohmann::json j;
+                i >> j;
+                for (auto& [game, stages] : j.items()) {
+                    auto& hist = games_[game];
+                    for (int s = 0; s < StageCount; ++s) {
+                        if (stages.contains(StageNames[s])) hist[s] = LatencyHistogram::fromJson(stages[StageNames[s]]);
+                    }
+                }
+            } catch (...) {}
+        }
+
+        void save() {
+            try {
+                nlohmann::json j;
+                for (const auto& [game, hist] : games_) {
+                    for (int s = 0; s < StageCount; ++s) {
+                        if (hist[s].count()) j[game][StageNames[s]] = hist[s].toJson();
+                    }
+                }
+                std::ofstream o("launch_metrics.json");
+                o << j.dump(2);
+            } catch (...) {}
+        }
+
+        // Polls the window list while launches wait for their first window
+        void windowLoop() {
+            WindowList windowList;
+            std::unique_lock<std::mutex> lk(m_);
+            while (!stopping_) {
+                if (windows_.empty()) {
+                    cv_.wait(lk, [this]() { return stopping_ || !windows_.empty(); });
+                    continue;
+                }
+                lk.unlock();
+                std::vector<std::string> owners = windowList.ownerExes();
+                lk.lock();
+                auto now = Clock::now();
+                std::erase_if(windows_, [&](const WindowWait& w) {
+                    if (std::find(owners.begin(), owners.end(), w.exe) != owners.end()) {
+                        recordLocked(w.game, Window, w.start);
+                        return true;
+                    }
+                    return now - w.start > WindowTimeout || !windowList.available();
+                });
+                cv_.wait_for(lk, WindowPoll, [this]() { return stopping_; });
+            }
+        }
+
+        // Lowercased executable basenames owning a top-level window
+        class WindowList {
+        public:
+#ifdef _WIN32
+            bool available() const { return true; }
+
+            std::vector<std::string> ownerExes() {
+                std::vector<DWORD> pids;
+                EnumWindows([](HWND hwnd, LPARAM param) -> BOOL {
+                    if (IsWindowVisible(hwnd) && GetWindow(hwnd, GW_OWNER) == NULL) {
+                        DWORD pid = 0;
+                        GetWindowThreadProcessId(hwnd, &pid);
+                        ((std::vector<DWORD>*)param)->push_back(pid);
+                    }
+                    return TRUE;
+                }, (LPARAM)&pids);
+                std::vector<std::string> exes;
+                for (DWORD pid : pids) {
+                    HANDLE h = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+                    if (!h) continue;
+                    char path[MAX_PATH];
+                    DWORD size = MAX_PATH;
+                    if (QueryFullProcessImageNameA(h, 0, path, &size)) {
+                        std::string_view exe(path, size);
+                        size_t slash = exe.find_last_of("/\\");
+                        if (slash != std::string_view::npos) exe = exe.substr(slash + 1);
+                        exes.push_back(ProcessSnapshot::lower(exe));
+                    }
+                    CloseHandle(h);
+                }
+                return exes;
+            }
+#else
+            // libxcb is loaded at run time: the launcher itself runs on GLFW and
+            // may be on Wayland without X linked in. xcb rather than Xlib: a
+            // window can close between _NET_CLIENT_LIST and the query of its
+            // pid, and xcb hands the BadWindow back with that reply, where Xlib
+            // would call its process-wide error handler, which GLFW swaps on
+            // the main thread and whose default exit()s.
+            WindowList() {
+                lib_ = dlopen("libxcb.so.1", RTLD_LAZY | RTLD_LOCAL);
+                if (!lib_) return;
+                connect_ = (ConnectFn)dlsym(lib_, "xcb_connect");
+                disconnect_ = (DisconnectFn)dlsym(lib_, "xcb_disconnect");
+                hasError_ = (HasErrorFn)dlsym(lib_, "xcb_connection_has_error");
+                getSetup_ = (GetSetupFn)dlsym(lib_, "xcb_get_setup");
+                rootsIterator_ = (RootsIteratorFn)dlsym(lib_, "xcb_setup_roots_iterator");
+                screenNext_ = (ScreenNextFn)dlsym(lib_, "xcb_screen_next");
+                internAtom_ = (InternAtomFn)dlsym(lib_, "xcb_intern_atom");
+                internAtomReply_ = (InternAtomReplyFn)dlsym(lib_, "xcb_intern_atom_reply");
+                getProperty_ = (GetPropertyFn)dlsym(lib_, "xcb_get_property");
+                getPropertyReply_ = (GetPropertyReplyFn)dlsym(lib_, "xcb_get_property_reply");
+                propertyValue_ = (PropertyValueFn)dlsym(lib_, "xcb_get_property_value");
+                propertyLength_ = (PropertyLengthFn)dlsym(lib_, "xcb_get_property_value_length");
+                if (!connect_ || !disconnect_ || !hasError_ || !getSetup_ || !rootsIterator_ || !screenNext_ ||
+                    !internAtom_ || !internAtomReply_ || !getProperty_ || !getPropertyReply_ || !propertyValue_ ||
+                    !propertyLength_) {
+                    return;
+                }
+                int screen = 0;
+                connection_ = connect_(nullptr, &screen);
+                if (hasError_(connection_)) return;
+                ScreenIterator it = rootsIterator_(getSetup_(connection_));
+                for (; it.rem > 0 && screen > 0; --screen) screenNext_(&it);
+                if (it.rem <= 0) return;
+                root_ = it.data->root;
+                clientList_ = atom("_NET_CLIENT_LIST");
+                wmPid_ = atom("_NET_WM_PID");
+            }
+            ~WindowList() {
+                // an xcb_connect that failed still returns a connection to free
+                if (connection_) disconnect_(connection_);
+                if (lib_) dlclose(lib_);
+            }
+            WindowList(const WindowList&) = delete;
+            WindowList& operator=(const WindowList&) = delete;
+
+            // Needs an X server (or XWayland) and an EWMH window manager
+            bool available() const { return root_ && clientList_ && wmPid_; }
+
+            std::vector<std::string> ownerExes() {
+                std::vector<std::string> exes;
+                if (!available() || hasError_(connection_)) return exes;
+                std::vector<uint32_t> windows = cardinals(getProperty_(connection_, 0, root_, clientList_, XA_WINDOW, 0, 4096));
+                // every request first, then the replies: one round trip for all windows
+                std::vector<Cookie> pids;
+                pids.reserve(windows.size());
+                for (uint32_t w : windows) pids.push_back(getProperty_(connection_, 0, w, wmPid_, XA_CARDINAL, 0, 1));
+                char path[64];
+                char cmdline[4096];
+                for (Cookie cookie : pids) {
+                    auto pid = cardinals(cookie);
+                    if (pid.empty()) continue;
+                    std::snprintf(path, sizeof(path), "/proc/%u/cmdline", pid[0]);
+                    int fd = open(path, O_RDONLY | O_CLOEXEC);
+                    if (fd < 0) continue;
+                    ssize_t n = read(fd, cmdline, sizeof(cmdline));
+                    close(fd);
+                    if (n <= 0) continue;
+                    std::string_view exe(cmdline, strnlen(cmdline, (size_t)n));
+                    size_t slash = exe.find_last_of("/\\");
+                    if (slash != std::string_view::npos) exe = exe.substr(slash + 1);
+                    exes.push_back(ProcessSnapshot::lower(exe));
+                }
+                return exes;
+            }
+
+        private:
+            // The few xcb types used, laid out as in xcb.h and xproto.h, so no
+            // X headers are needed
+            struct Connection;
+            struct Setup;
+            struct Cookie { unsigned int sequence; };
+            struct Screen { uint32_t root; };
+            struct ScreenIterator {
+                Screen* data;
+                int rem;
+                int index;
+            };
+            struct AtomReply {
+                uint8_t responseType, pad0;
+                uint16_t sequence;
+                uint32_t length;
+                uint32_t atom;
+            };
+            struct PropertyReply {
+                uint8_t responseType, format;
+                uint16_t sequence;
+                uint32_t length, type, bytesAfter, valueLength;
+                uint8_t pad0[12];
+            };
+            struct Error;
+            static constexpr uint32_t XA_CARDINAL = 6;
+            static constexpr uint32_t XA_WINDOW = 33;
+            using ConnectFn = Connection* (*)(const char*, int*);
+            using DisconnectFn = void (*)(Connection*);
+            using HasErrorFn = int (*)(Connection*);
+            using GetSetupFn = const Setup* (*)(Connection*);
+            using RootsIteratorFn = ScreenIterator (*)(const Setup*);
+            using ScreenNextFn = void (*)(ScreenIterator*);
+            using InternAtomFn = Cookie (*)(Connection*, uint8_t, uint16_t, const char*);
+            using InternAtomReplyFn = AtomReply* (*)(Connection*, Cookie, Error**);
+            using GetPropertyFn = Cookie (*)(Connection*, uint8_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+            using GetPropertyReplyFn = PropertyReply* (*)(Connection*, Cookie, Error**);
+            using PropertyValueFn = void* (*)(const PropertyReply*);
+            using PropertyLengthFn = int (*)(const PropertyReply*);
+
+            void* lib_ = nullptr;
+            Connection* connection_ = nullptr;
+            ConnectFn connect_ = nullptr;
+            DisconnectFn disconnect_ = nullptr;
+            HasErrorFn hasError_ = nullptr;
+            GetSetupFn getSetup_ = nullptr;
+            RootsIteratorFn rootsIterator_ = nullptr;
+            ScreenNextFn screenNext_ = nullptr;
+            InternAtomFn internAtom_ = nullptr;
+            InternAtomReplyFn internAtomReply_ = nullptr;
+            GetPropertyFn getProperty_ = nullptr;
+            GetPropertyReplyFn getPropertyReply_ = nullptr;
+            PropertyValueFn propertyValue_ = nullptr;
+            PropertyLengthFn propertyLength_ = nullptr;
+            uint32_t root_ = 0;
+            uint32_t clientList_ = 0;
+            uint32_t wmPid_ = 0;
+
+            // 0 if the window manager never created it
+            uint32_t atom(const char* name) {
+                Error* error = nullptr;
+                AtomReply* reply = internAtomReply_(connection_, internAtom_(connection_, 1, (uint16_t)std::strlen(name), name), &error);
+                uint32_t atom = reply ? reply->atom : 0;
+                std::free(reply);
+                std::free(error);
+                return atom;
+            }
+
+            // The reply to a format-32 property request; empty on any error,
+            // e.g. BadWindow for a window that is gone
+            std::vector<uint32_t> cardinals(Cookie cookie) {
+                Error* error = nullptr;
+                PropertyReply* reply = getPropertyReply_(connection_, cookie, &error);
+                std::vector<uint32_t> out;
+                if (reply && reply->format == 32) {
+                    const uint32_t* values = (const uint32_t*)propertyValue_(reply);
+                    out.assign(values, values + propertyLength_(reply) / sizeof(uint32_t));
+                }
+                std::free(reply);
+                std::free(error);
+                return out;
+            }
+#endif
+        };
+    };
+
+}
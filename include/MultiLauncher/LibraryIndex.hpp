@@ -0,0 +1,145 @@
+#pragma once
+#include "Game.hpp"
+#include "MappedFile.hpp"
+#include "Logger.hpp"
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+namespace MultiLauncher {
+
+    // Versioned on-disk snapshot of the game list, written after every scan and
+    // mapped on startup so the "Games" panel is populated before any scanner runs.
+    //
+    // Layout: Header | Record[count] | string blob. Records reference the blob by
+    // offset/length so loading is a bounds check plus one Game per record.
+    class LibraryIndex {
+    public:
+        static constexpr uint32_t Magic = 0x58494C4D; // "MLIX"
+        static constexpr uint32_t Version = 1;
+
+        static std::filesystem::path defaultPath() { return "library.idx"; }
+
+        static bool save(const std::vector<std::shared_ptr<Game> >& games, const std::filesystem::path& path = defaultPath()) {
+            std::vector<Record> records;
+            std::string blob;
+            records.reserve(games.size());
+            for (const auto& g : games) {
+                Record r{};
+                r.launcher = (uint32_t)g->getLauncherType();
+                r.steamAppId = g->getSteamAppId();
+                appendString(blob, g->getName(), r.nameOff, r.nameLen);
+                appendString(blob, g->getPath().u8string(), r.pathOff, r.pathLen);
+                appendString(blob, g->getExeName(), r.exeOff, r.exeLen);
+                records.push_back(r);
+            }
+
+            Header h{};
+            h.magic = Magic;
+            h.version = Version;
+            h.count = (uint32_t)records.size();
+            h.blobSize = (uint32_t)blob.size();
+
+            // Write to a temp file and rename so a crash never leaves a torn index
+            std::filesystem::path tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                if (!out) {
+                    Logger::instance().error("Could not write library index: " + tmp.string());
+                    return false;
+                }
+                out.write((const char*)&h, sizeof(h));
+                if (!records.empty()) out.write((const char*)records.data(), records.size() * sizeof(Record));
+                out.write(blob.data(), blob.size());
+                if (!out) {
+                    Logger::instance().error("Failed writing library index: " + tmp.string());
+                    return false;
+                }
+            }
+            std::error_code ec;
+            std::filesystem::rename(tmp, path, ec);
+            if (ec) {
+                Logger::instance().error("Could not replace library index: " + ec.message());
+                return false;
+            }
+            return true;
+        }
+
+        // Returns an empty list if the file is missing, truncated or from another version
+        static std::vector<Game> load(const std::filesystem::path& path = defaultPath()) {
+            std::vector<Game> games;
+            MappedFile file;
+            if (!file.open(path)) return games;
+
+            if (file.size() < sizeof(Header)) return games;
+            Header h;
+            std::memcpy(&h, file.data(), sizeof(h));
+            if (h.magic != Magic || h.version != Version) {
+                Logger::instance().info("Ignoring library index with unknown format");
+                return games;
+            }
+            const size_t recordsBytes = (size_t)h.count * sizeof(Record);
+            if (file.size() != sizeof(Header) + recordsBytes + h.blobSize) {
+                Logger::instance().error("Library index is corrupt, ignoring it");
+                return games;
+            }
+            const char* recordsBase = file.data() + sizeof(Header);
+            const char* blob = recordsBase + recordsBytes;
+
+            auto str = [&](uint32_t off, uint32_t len, std::string& out) {
+                if ((size_t)off + len > h.blobSize) return false;
+                out.assign(blob + off, len);
+                return true;
+            };
+
+            games.reserve(h.count);
+            for (uint32_t i = 0; i < h.count; ++i) {
+                Record r;
+                std::memcpy(&r, recordsBase + (size_t)i * sizeof(Record), sizeof(r));
+                if (r.launcher > Game::GOG) continue;
+                std::string name, path8, exe;
+                if (!str(r.nameOff, r.nameLen, name) ||
+                    !str(r.pathOff, r.pathLen, path8) ||
+                    !str(r.exeOff, r.exeLen, exe)) {
+                    continue;
+                }
+                games.emplace_back(
+                    name,
+                    (Game::LauncherType)r.launcher,
+                    std::filesystem::path(std::u8string(path8.begin(), path8.end())),
+                    exe,
+                    r.steamAppId
+                );
+            }
+            return games;
+        }
+
+    private:
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t count;
+            uint32_t blobSize;
+        };
+        struct Record {
+            uint32_t launcher;
+            int32_t steamAppId;
+            uint32_t nameOff, nameLen;
+            uint32_t pathOff, pathLen;
+            uint32_t exeOff, exeLen;
+        };
+
+        template <typename S>
+        static void appendString(std::string& blob, const S& s, uint32_t& off, uint32_t& len) {
+            off = (uint32_t)blob.size();
+            len = (uint32_t)s.size();
+            blob.append((const char*)s.data(), s.size());
+        }
+    };
+
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include "IScanner.hpp"
+#include "Logger.hpp"
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <climits>
+#endif
+
+namespace MultiLauncher {
+
+    // Watches the directories scanners report through IScanner::watchTargets()
+    // and reports debounced batches of relevant file changes. Linux only
+    // (inotify); on other platforms start() returns false and nothing happens.
+    class LibraryWatcher {
+    public:
+        struct Change {
+            enum Kind { Added, Modified, Removed, Unknown };
+            Game::LauncherType launcher = Game::STEAM;
+            Kind kind = Unknown;
+            std::filesystem::path path; // empty when the kernel queue overflowed
+        };
+        using Callback = std::function<void(const std::vector<Change>&)>;
+
+        // A batch is delivered once no event arrived for Quiet, or at the
+        // latest MaxDelay after its first event (a long Steam update keeps
+        // touching its manifest).
+        static constexpr std::chrono::milliseconds Quiet{1000};
+        static constexpr std::chrono::milliseconds MaxDelay{5000};
+
+        LibraryWatcher() = default;
+        LibraryWatcher(const LibraryWatcher&) = delete;
+        LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+        ~LibraryWatcher() { stop(); }
+
+        bool start(Callback cb) {
+#ifdef __linux__
+            std::lock_guard<std::mutex> lk(m_);
+            if (running_) return true;
+            inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotifyFd_ < 0) {
+                Logger::instance().error("Library watcher: inotify unavailable, use Refresh Game List instead");
+                return false;
+            }
+            wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            callback_ = std::move(cb);
+            running_ = true;
+            for (const auto& [launcher, _] : targets_) applyLocked(launcher);
+            thread_ = std::thread([this]() { loop(); });
+            return true;
+#else
+            (void)cb;
+            return false;
+#endif
+        }
+
+        void stop() {
+#ifdef __linux__
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (!running_) return;
+                running_ = false;
+            }
+            uint64_t one = 1;
+            if (wakeFd_ >= 0) (void)!write(wakeFd_, &one, sizeof(one));
+            if (thread_.joinable()) thread_.join();
+            close(inotifyFd_);
+            if (wakeFd_ >= 0) close(wakeFd_);
+            inotifyFd_ = wakeFd_ = -1;
+            watches_.clear();
+#endif
+        }
+
+        // Replaces everything watched on behalf of one launcher
+        void setTargets(Game::LauncherType launcher, std::vector<WatchTarget> targets) {
+            std::lock_guard<std::mutex> lk(m_);
+            targets_[launcher] = std::move(targets);
+#ifdef __linux__
+            if (running_) applyLocked(launcher);
+#endif
+        }
+
+    private:
+        std::mutex m_;
+        std::map<Game::LauncherType, std::vector<WatchTarget> > targets_;
+        Callback callback_;
+        bool running_ = false;
+        std::thread thread_;
+
+#ifdef __linux__
+        struct Watch {
+            std::filesystem::path dir;
+            std::vector<std::pair<Game::LauncherType, WatchTarget> > owners;
+        };
+        int inotifyFd_ = -1;
+        int wakeFd_ = -1;
+        std::unordered_map<int, Watch> watches_;
+
+        void applyLocked(Game::LauncherType launcher) {
+            for (auto& [wd, w] : watches_) {
+                std::erase_if(w.owners, [&](const auto& o) { return o.first == launcher; });
+            }
+            for (const auto& t : targets_[launcher]) {
+                int wd = inotify_add_watch(inotifyFd_, t.dir.c_str(),
+                    IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_CLOSE_WRITE | IN_ONLYDIR);
+                if (wd < 0) continue;
+                auto& w = watches_[wd];
+                w.dir = t.dir;
+                w.owners.emplace_back(launcher, t);
+            }
+            for (auto it = watches_.begin(); it != watches_.end();) {
+                if (it->second.owners.empty()) {
+                    inotify_rm_watch(inotifyFd_, it->first);
+                    it = watches_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        static bool matches(const WatchTarget& t, const std::string& file) {
+            if (file.size() < t.prefix.size() + t.suffix.size()) return false;
+            return file.compare(0, t.prefix.size(), t.prefix) == 0 &&
+                   file.compare(file.size() - t.suffix.size(), t.suffix.size(), t.suffix) == 0;
+        }
+
+        void loop() {
+            using clock = std::chrono::steady_clock;
+            std::map<std::string, Change> pending; // keyed by path, collapses repeats
+            clock::time_point first, last;
+            alignas(inotify_event) char buf[64 * 1024];
+
+            while (true) {
+                int timeout = -1;
+                if (!pending.empty()) {
+                    auto now = clock::now();
+                    auto due = std::min(last + Quiet, first + MaxDelay);
+                    timeout = (int)std::max<long long>(0,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count());
+                }
+
+                pollfd fds[2] = { { inotifyFd_, POLLIN, 0 }, { wakeFd_, POLLIN, 0 } };
+                int n = poll(fds, 2, timeout);
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    if (!running_) return;
+                }
+
+                if (n > 0 && (fds[0].revents & POLLIN)) {
+                    ssize_t len;
+                    while ((len = read(inotifyFd_, buf, sizeof(buf))) > 0) {
+                        std::lock_guard<std::mutex> lk(m_);
+                        for (char* p = buf; p < buf + len;) {
+                            auto* ev = (inotify_event*)p;
+                            p += sizeof(inotify_event) + ev->len;
+                            collect(*ev, pending);
+                        }
+                    }
+                    if (!pending.empty()) {
+                        last = clock::now();
+                        if (first == clock::time_point{}) first = last;
+                    }
+                }
+
+                if (pending.empty()) continue;
+                auto now = clock::now();
+                if (now - last >= Quiet || now - first >= MaxDelay) {
+                    std::vector<Change> batch;
+                    batch.reserve(pending.size());
+                    for (auto& [_, c] : pending) batch.push_back(std::move(c));
+                    pending.clear();
+                    first = clock::time_point{};
+                    if (callback_) callback_(batch);
+                }
+            }
+        }
+
+        void collect(const inotify_event& ev, std::map<std::string, Change>& pending) {
+            if (ev.mask & IN_Q_OVERFLOW) {
+                // Lost events: make every launcher rescan
+                for (const auto& [launcher, _] : targets_) {
+                    pending["overflow:" + std::to_string((int)launcher)] = { launcher, Change::Unknown, {} };
+                }
+                return;
+            }
+            auto it = watches_.find(ev.wd);
+            if (it == watches_.end()) return;
+            if (ev.mask & IN_IGNORED) {
+                // Directory itself went away (library removed)
+                for (const auto& [launcher, t] : it->second.owners) {
+                    pending[it->second.dir.string()] = { launcher, Change::Removed, it->second.dir };
+                }
+                watches_.erase(it);
+                return;
+            }
+            if (ev.len == 0) return;
+            std::string file(ev.name);
+            Change::Kind kind = Change::Modified;
+            if (ev.mask & (IN_CREATE | IN_MOVED_TO)) kind = Change::Added;
+            else if (ev.mask & (IN_DELETE | IN_MOVED_FROM)) kind = Change::Removed;
+
+            for (const auto& [launcher, t] : it->second.owners) {
+                if (!matches(t, file)) continue;
+                std::filesystem::path path = it->second.dir / file;
+                auto& slot = pending[path.string()];
+                // created then written is still an addition
+                if (!(slot.kind == Change::Added && kind == Change::Modified)) {
+                    slot = { launcher, kind, path };
+                }
+            }
+        }
+#endif
+    };
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <cstddef>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace MultiLauncher {
+
+    // Read-only memory mapping of a whole file. Empty files map to an empty view.
+    // Files below SmallFileLimit are read into a buffer instead: for a 1 KB
+    // appmanifest the mmap/munmap pair costs more than the copy.
+    class MappedFile {
+    public:
+        static constexpr size_t SmallFileLimit = 64 * 1024;
+
+        MappedFile() = default;
+        explicit MappedFile(const std::filesystem::path& path) { open(path); }
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this != &other) {
+                close();
+                bool otherSmall = other.data_ && other.data_ == other.small_.data();
+                small_ = std::move(other.small_);
+                data_ = otherSmall ? small_.data() : other.data_;
+                size_ = other.size_;
+                opened_ = other.opened_;
+#ifdef _WIN32
+                mapping_ = other.mapping_;
+                other.mapping_ = NULL;
+#endif
+                other.data_ = nullptr;
+                other.size_ = 0;
+                other.opened_ = false;
+            }
+            return *this;
+        }
+
+        bool open(const std::filesystem::path& path) {
+            close();
+#ifdef _WIN32
+            HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size)) {
+                CloseHandle(file);
+                return false;
+            }
+            size_ = (size_t)size.QuadPart;
+            if (size_ > 0 && size_ < SmallFileLimit) {
+                small_.resize(size_);
+                DWORD got = 0;
+                if (!ReadFile(file, small_.data(), (DWORD)size_, &got, NULL) || got != size_) {
+                    CloseHandle(file);
+                    small_.clear();
+                    size_ = 0;
+                    return false;
+                }
+                data_ = small_.data();
+            } else if (size_ > 0) {
+                mapping_ = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping_) data_ = (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+                if (!data_) {
+                    if (mapping_) CloseHandle(mapping_);
+                    mapping_ = NULL;
+                    CloseHandle(file);
+                    size_ = 0;
+                    return false;
+                }
+            }
+            CloseHandle(file);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                return false;
+            }
+            size_ = (size_t)st.st_size;
+            if (size_ > 0 && size_ < SmallFileLimit) {
+                small_.resize(size_);
+                size_t got = 0;
+                while (got < size_) {
+                    ssize_t n = ::read(fd, small_.data() + got, size_ - got);
+                    if (n <= 0) break;
+                    got += (size_t)n;
+                }
+                if (got != size_) {
+                    ::close(fd);
+                    small_.clear();
+                    size_ = 0;
+                    return false;
+                }
+                data_ = small_.data();
+            } else if (size_ > 0) {
+                void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    ::close(fd);
+                    size_ = 0;
+                    return false;
+                }
+                madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = (const char*)p;
+            }
+            ::close(fd);
+#endif
+            opened_ = true;
+            return true;
+        }
+
+        void close() {
+            if (data_ && data_ != small_.data()) {
+#ifdef _WIN32
+                UnmapViewOfFile(data_);
+#else
+                munmap((void*)data_, size_);
+#endif
+            }
+#ifdef _WIN32
+            if (mapping_) CloseHandle(mapping_);
+            mapping_ = NULL;
+#endif
+            small_.clear();
+            data_ = nullptr;
+            size_ = 0;
+            opened_ = false;
+        }
+
+        bool isOpen() const { return opened_; }
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+        std::string_view view() const { return std::string_view(data_ ? data_ : "", size_); }
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool opened_ = false;
+        std::string small_;
+#ifdef _WIN32
+        HANDLE mapping_ = NULL;
+#endif
+    };
+
+}
@@ -4,9 +4,22 @@
 #include <vector>
 #include <filesystem>
 #include <fstream>
-#include <regex>
 #include <iostream>
+#include <algorithm>
+#include <charconv>
 #include "../external/JSON/json.hpp"
+#include "MappedFile.hpp"
+#include "VdfReader.hpp"
+#include "Logger.hpp"
+#include "SessionTracker.hpp"
+#include "Executor.hpp"
+#include <optional>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdint>
 
 namespace MultiLauncher {
 
@@ -20,14 +33,38 @@ namespace MultiLauncher {
         void init() {
             loadLocal();
             scanSteam();
+            ready_.store(true);
         }
 
+        // Same as init() but on a background thread: big localconfig.vdf files
+        // must not delay the first frame. Queries return 0 until isReady().
+        void initAsync(std::function<void()> onReady = nullptr) {
+            Executor::instance().submit(Executor::Background, [this, onReady]() {
+                auto begin = std::chrono::steady_clock::now();
+                init();
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+                size_t apps = 0;
+                {
+                    std::lock_guard<std::mutex> lock(m_);
+                    apps = steamPlaytimeMap.size();
+                }
+                Logger::instance().info("Loaded playtime for " + std::to_string(apps) + " Steam apps in " +
+                    std::to_string(ms) + " ms");
+                if (onReady) onReady();
+            });
+        }
+
+        bool isReady() const { return ready_.load(); }
+
         // Returns hours
         float getHours(const std::string& gameName, int steamAppId) {
+            std::lock_guard<std::mutex> lock(m_);
             float minutes = 0.0f;
             
-            if (steamAppId > 0 && steamPlaytimeMap.count(steamAppId)) {
-                minutes = (float)steamPlaytimeMap[steamAppId];
+            auto steam = steamAppId > 0 ? steamPlaytimeMap.find(steamAppId) : steamPlaytimeMap.end();
+            if (steam != steamPlaytimeMap.end()) {
+                minutes = (float)steam->second.minutes;
             } 
             else if (localPlaytimeMap.count(gameName)) {
                 minutes = (float)localPlaytimeMap[gameName];
@@ -36,18 +73,52 @@ namespace MultiLauncher {
             return minutes / 60.0f;
         }
 
+        // Unix time Steam last started the app, 0 if unknown
+        int64_t getLastPlayed(int steamAppId) {
+            std::lock_guard<std::mutex> lock(m_);
+            auto it = steamPlaytimeMap.find(steamAppId);
+            return it != steamPlaytimeMap.end() ? it->second.lastPlayed : 0;
+        }
+
+        // Called when a play session ends. Steam counts playtime itself, so its
+        // sessions are only remembered for display.
+        void recordSession(const LaunchSession& session, bool steamTracked) {
+            if (!session.gameSeen) return;
+            {
+                std::lock_guard<std::mutex> lock(m_);
+                lastSessions[session.game] = session;
+            }
+            if (!steamTracked) addPlaytime(session.game, session.minutes());
+        }
+
+        std::optional<LaunchSession> getLastSession(const std::string& gameName) {
+            std::lock_guard<std::mutex> lock(m_);
+            auto it = lastSessions.find(gameName);
+            if (it == lastSessions.end()) return std::nullopt;
+            return it->second;
+        }
+
         void addPlaytime(const std::string& gameName, int minutes) {
             if (minutes <= 0) return;
             
+            std::lock_guard<std::mutex> lock(m_);
             localPlaytimeMap[gameName] += minutes;
             saveLocal();
         }
 
     private:
         PlaytimeManager() {}
+
+        struct SteamPlaytime {
+            int minutes = 0;
+            int64_t lastPlayed = 0;
+        };
         
+        std::mutex m_;
+        std::atomic<bool> ready_ = false;
         std::unordered_map<std::string, int> localPlaytimeMap; // Name -> Minutes
-        std::unordered_map<int, int> steamPlaytimeMap;       // AppID -> Minutes
+        std::unordered_map<int, SteamPlaytime> steamPlaytimeMap; // AppID -> Minutes, last played
+        std::unordered_map<std::string, LaunchSession> lastSessions; // this run only
 
         void loadLocal() {
             if (!std::filesystem::exists("playtime.json")) return;
@@ -55,6 +126,7 @@ namespace MultiLauncher {
                 std::ifstream i("playtime.json");
                 nlohmann::json j;
                 i >> j;
+                std::lock_guard<std::mutex> lock(m_);
                 for (auto& element : j.items()) {
                     localPlaytimeMap[element.key()] = element.value().get<int>();
                 }
@@ -93,31 +165,57 @@ namespace MultiLauncher {
             }
         }
 
-        // Basic VDF parser for playtime
+        // localconfig.vdf keeps per-app stats at
+        // UserLocalConfigStore/Software/Valve/Steam/apps/<appid>/{Playtime,LastPlayed}.
+        // Only that path is followed; every other subtree (friends, broadcast,
+        // per-app cloud state, ...) is skipped without looking at its contents.
         void parseVDF(const std::string& path) {
-            std::ifstream file(path);
-            if (!file.is_open()) return;
+            MappedFile file(path);
+            if (!file.isOpen()) return;
 
-            std::string line;
-            std::string currentAppId = "";
-            bool inApps = false;
-            
-            while (std::getline(file, line)) {
-                
-                std::smatch m;
-                static std::regex reAppId(R"(\s*\"(\d+)\"\s*)");
-                static std::regex rePlaytime(R"(\s*\"Playtime\"\s*\"(\d+)\"\s*)");
-
-                if (std::regex_match(line, m, reAppId)) {
-                    currentAppId = m[1].str();
-                }
-                else if (!currentAppId.empty() && std::regex_match(line, m, rePlaytime)) {
-                    try {
-                        int mins = std::stoi(m[1].str());
-                        steamPlaytimeMap[std::stoi(currentAppId)] = mins;
-                    } catch (...) {}
+            static const std::string_view appsPath[] = { "Software", "Valve", "Steam", "apps" };
+            constexpr int AppsDepth = 5;   // inside "apps"
+            constexpr int AppDepth = 6;    // inside "<appid>"
+
+            VdfReader reader(file.view());
+            VdfReader::Event ev;
+            std::unordered_map<int, SteamPlaytime> found;
+            int appId = 0;
+            SteamPlaytime current;
+            bool haveStats = false;
+
+            auto toInt = [](std::string_view v, auto& out) {
+                return std::from_chars(v.data(), v.data() + v.size(), out).ec == std::errc();
+            };
+
+            while (reader.next(ev)) {
+                int depth = reader.depth();
+                if (ev.type == VdfReader::Event::ObjectBegin) {
+                    if (depth == 1) continue; // root, name varies between clients
+                    if (depth <= AppsDepth) {
+                        if (!VdfReader::equalsNoCase(ev.key, appsPath[depth - 2])) reader.skipObject();
+                    } else if (depth == AppDepth && toInt(ev.key, appId)) {
+                        current = {};
+                        haveStats = false;
+                    } else {
+                        reader.skipObject();
+                    }
+                } else if (ev.type == VdfReader::Event::KeyValue && depth == AppDepth) {
+                    if (VdfReader::equalsNoCase(ev.key, "Playtime")) haveStats |= toInt(ev.value, current.minutes);
+                    else if (VdfReader::equalsNoCase(ev.key, "LastPlayed")) haveStats |= toInt(ev.value, current.lastPlayed);
+                } else if (ev.type == VdfReader::Event::ObjectEnd && depth == AppsDepth && haveStats) {
+                    found[appId] = current;
+                    haveStats = false;
                 }
             }
+
+            // Several Steam accounts on one machine: keep the larger numbers
+            std::lock_guard<std::mutex> lock(m_);
+            for (const auto& [id, stats] : found) {
+                auto& dst = steamPlaytimeMap[id];
+                dst.minutes = std::max(dst.minutes, stats.minutes);
+                dst.lastPlayed = std::max(dst.lastPlayed, stats.lastPlayed);
+            }
         }
     };
 
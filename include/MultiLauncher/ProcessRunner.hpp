@@ -1,7 +1,14 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <functional>
 #include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -9,19 +16,399 @@
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/wait.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <cerrno>
 #include <cstring>
-#include <array>
-#include <memory>
+
+extern char** environ;
 #endif
 #include "Logger.hpp"
+#include "Executor.hpp"
 
 namespace MultiLauncher {
+    // A child started by spawnAsync. It runs in its own process group (a
+    // job object on Windows), so stopping it also reaches the processes it
+    // started, e.g. legendary's download workers.
+    class ProcessHandle : public std::enable_shared_from_this<ProcessHandle> {
+    public:
+        enum Signal {
+            Interrupt, // SIGINT: legendary saves its resume state and exits
+            Terminate, // SIGTERM
+            Kill,      // SIGKILL, TerminateJobObject on Windows
+            Suspend,   // SIGSTOP; refused once stop() was called
+            Continue   // SIGCONT
+        };
+        // How long stop() waits after each signal before escalating
+        static constexpr std::chrono::milliseconds StopGrace{5000};
+
+        bool running() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return started_ && !finished_;
+        }
+        // Exited and its output was read to the end
+        bool finished() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return finished_;
+        }
+        // Valid once finished; -1 if it did not start or was killed
+        int exitCode() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return exitCode_;
+        }
+        // stop() was called, whether or not the process had started
+        bool cancelled() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return cancelled_;
+        }
+
+        // False on timeout
+        bool wait(std::chrono::milliseconds timeout) const {
+            std::unique_lock<std::mutex> lk(m_);
+            return cv_.wait_for(lk, timeout, [this]() { return finished_; });
+        }
+
+        // Sends sig to the whole process group. False if the process is not
+        // running or the signal cannot be delivered on this platform.
+        bool signal(Signal sig) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!started_ || exited_) return false;
+            if (sig == Suspend && cancelled_) return false;
+#ifdef _WIN32
+            // A windowless child has its own console, so there is no Ctrl+C
+            // to send it; only the job can be terminated
+            if (sig != Kill) return false;
+            return TerminateJobObject(job_, 1) != 0;
+#else
+            static const int signals[] = { SIGINT, SIGTERM, SIGKILL, SIGSTOP, SIGCONT };
+            return kill(-pid_, signals[sig]) == 0;
+#endif
+        }
+
+        // Idle I/O priority for the whole group on Linux, idle CPU priority
+        // for the job on Windows; false turns it back to normal
+        bool setBackground(bool background) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!started_ || exited_) return false;
+#ifdef _WIN32
+            JOBOBJECT_BASIC_LIMIT_INFORMATION info = {};
+            if (background) {
+                info.LimitFlags = JOB_OBJECT_LIMIT_PRIORITY_CLASS;
+                info.PriorityClass = IDLE_PRIORITY_CLASS;
+            }
+            return SetInformationJobObject(job_, JobObjectBasicLimitInformation, &info, sizeof(info)) != 0;
+#else
+            // ioprio_set has no glibc wrapper: who 2 = IOPRIO_WHO_PGRP,
+            // class 3 = idle, class 2 level 4 = best effort default
+            int prio = background ? (3 << 13) : ((2 << 13) | 4);
+            return syscall(SYS_ioprio_set, 2, pid_, prio) == 0;
+#endif
+        }
+
+        // Caps the job's network bandwidth (0 lifts the cap). Only Windows
+        // can do this per process; on Linux this returns false.
+        bool limitBandwidth(uint64_t bytesPerSec) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!started_ || exited_) return false;
+#ifdef _WIN32
+            JOBOBJECT_NET_RATE_CONTROL_INFORMATION info = {};
+            info.ControlFlags = bytesPerSec
+                ? (JOB_OBJECT_NET_RATE_CONTROL_FLAGS)(JOB_OBJECT_NET_RATE_CONTROL_ENABLE | JOB_OBJECT_NET_RATE_CONTROL_MAX_BANDWIDTH)
+                : (JOB_OBJECT_NET_RATE_CONTROL_FLAGS)0;
+            info.MaxBandwidth = bytesPerSec;
+            return SetInformationJobObject(job_, JobObjectNetRateControlInformation, &info, sizeof(info)) != 0;
+#else
+            (void)bytesPerSec;
+            return false;
+#endif
+        }
+
+        // Interrupt, then terminate, then kill, waiting `grace` after each.
+        // Blocks; returns false if the process outlived all three. A process
+        // that has not started yet is not started at all.
+        bool stop(std::chrono::milliseconds grace = StopGrace) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                cancelled_ = true;
+                if (!started_ || finished_) return true;
+            }
+            // a suspended (throttled) group would not act on the interrupt
+            signal(Continue);
+            for (Signal sig : { Interrupt, Terminate }) {
+                if (signal(sig) && wait(grace)) return true;
+                if (finished()) return true;
+            }
+            signal(Kill);
+            return wait(grace);
+        }
+
+        // stop() on an executor thread; the UI must not block on it. Runs on
+        // the Stop lane: the Process lane may be full of children that only
+        // end once they are stopped.
+        void stopAsync(std::function<void(bool)> onStopped = nullptr, std::chrono::milliseconds grace = StopGrace) {
+            Executor::instance().submit(Executor::Stop, [self = shared_from_this(), onStopped, grace]() {
+                bool stopped = self->stop(grace);
+                if (onStopped) onStopped(stopped);
+            });
+        }
+
+#ifdef _WIN32
+        ~ProcessHandle() {
+            if (job_) CloseHandle(job_);
+        }
+#endif
+
+    private:
+        friend class ProcessRunner;
+
+        mutable std::mutex m_;
+        mutable std::condition_variable cv_;
+        bool cancelled_ = false;
+        bool started_ = false;
+        bool exited_ = false;   // reaped or about to be: its pid may be reused
+        bool finished_ = false;
+        int exitCode_ = -1;
+#ifdef _WIN32
+        HANDLE job_ = NULL;
+#else
+        pid_t pid_ = 0;
+#endif
+
+        // The runner's side. startable() is checked right before starting;
+        // attach() returns false if stop() came in between, and the runner
+        // kills the fresh process.
+        bool startable() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return !cancelled_;
+        }
+#ifdef _WIN32
+        bool attach(HANDLE job) {
+            std::lock_guard<std::mutex> lk(m_);
+            job_ = job;
+            started_ = true;
+            return !cancelled_;
+        }
+#else
+        bool attach(pid_t pid) {
+            std::lock_guard<std::mutex> lk(m_);
+            pid_ = pid;
+            started_ = true;
+            return !cancelled_;
+        }
+#endif
+        void exited() {
+            std::lock_guard<std::mutex> lk(m_);
+            exited_ = true;
+        }
+        void finish(int code) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                exited_ = true;
+                finished_ = true;
+                exitCode_ = code;
+            }
+            cv_.notify_all();
+        }
+    };
+
     class ProcessRunner {
     public:
         using OutputCallback = std::function<void(const std::string&)>;
+        // The view is only valid during the call
+        using LineCallback = std::function<void(std::string_view)>;
+
+        // Bytes read from a pipe at a time; also the longest line delivered in one piece
+        static constexpr size_t ReadSize = 64 * 1024;
+
+        // Runs argv[0] (looked up in PATH) with no shell in between, so
+        // arguments need no quoting. stdout and stderr lines arrive on their
+        // own callbacks; stderr goes to onOutput when onError is not set.
+        // Returns the exit code, or -1 if the process could not be started or
+        // was killed. With a handle the child gets its own process group and
+        // can be stopped through it; a handle stopped before the start means
+        // the child is never started.
+        static int spawn(const std::vector<std::string>& argv, LineCallback onOutput = nullptr,
+                         const std::string& workingDir = "", LineCallback onError = nullptr,
+                         ProcessHandle* handle = nullptr) {
+            if (argv.empty()) return finish(handle, -1);
+#ifdef _WIN32
+            // CreateProcess takes one command line; quote each argument the way
+            // the MSVC runtime splits it again
+            std::string cmd;
+            for (const auto& arg : argv) {
+                if (!cmd.empty()) cmd += ' ';
+                if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos) {
+                    cmd += arg;
+                    continue;
+                }
+                cmd += '"';
+                size_t backslashes = 0;
+                for (char c : arg) {
+                    if (c == '\\') {
+                        backslashes++;
+                        continue;
+                    }
+                    cmd.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+                    backslashes = 0;
+                    cmd += c;
+                }
+                cmd.append(backslashes * 2, '\\');
+                cmd += '"';
+            }
+            (void)onError; // the Windows runner merges stderr into stdout
+            return runProcess(cmd, onOutput ? [&](const std::string& line) { onOutput(line); } : OutputCallback(), workingDir, handle);
+#else
+            if (handle && !handle->startable()) return finish(handle, -1);
+            int out[2], err[2];
+            if (pipe2(out, O_CLOEXEC) != 0) return finish(handle, -1);
+            if (pipe2(err, O_CLOEXEC) != 0) {
+                close(out[0]);
+                close(out[1]);
+                return finish(handle, -1);
+            }
+
+            // dup2 onto 1 and 2 clears O_CLOEXEC there; every other pipe end
+            // stays closed in the child
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+            posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+            if (!workingDir.empty()) posix_spawn_file_actions_addchdir_np(&actions, workingDir.c_str());
+
+            std::vector<char*> args;
+            args.reserve(argv.size() + 1);
+            for (const auto& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+            args.push_back(nullptr);
+
+            // A group of its own, so the handle can signal everything it starts
+            posix_spawnattr_t attr;
+            posix_spawnattr_init(&attr);
+            if (handle) {
+                posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+                posix_spawnattr_setpgroup(&attr, 0);
+            }
+
+            pid_t pid;
+            int rc;
+            {
+                // registered before SessionTracker can see the child's zombie
+                std::lock_guard<std::mutex> lk(waited().m);
+                rc = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+                if (rc == 0) waited().pids.insert(pid);
+            }
+            posix_spawn_file_actions_destroy(&actions);
+            posix_spawnattr_destroy(&attr);
+            close(out[1]);
+            close(err[1]);
+            if (rc != 0) {
+                close(out[0]);
+                close(err[0]);
+                Logger::instance().error("Failed to start " + argv[0] + ": " + std::strerror(rc));
+                return finish(handle, -1);
+            }
+            if (handle && !handle->attach(pid)) kill(-pid, SIGKILL);
+
+            LineSplitter outLines(onOutput);
+            LineSplitter errLines(onError ? onError : onOutput);
+            pollfd fds[2] = { { out[0], POLLIN, 0 }, { err[0], POLLIN, 0 } };
+            LineSplitter* splitters[2] = { &outLines, &errLines };
+            int openPipes = 2;
+            while (openPipes > 0) {
+                if (poll(fds, 2, -1) < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                for (int i = 0; i < 2; ++i) {
+                    if (fds[i].fd < 0 || !fds[i].revents) continue;
+                    if (!splitters[i]->readFrom(fds[i].fd)) {
+                        close(fds[i].fd);
+                        fds[i].fd = -1; // poll ignores negative fds
+                        openPipes--;
+                    }
+                }
+            }
+            for (auto& fd : fds) {
+                if (fd.fd >= 0) close(fd.fd);
+            }
+            outLines.finish();
+            errLines.finish();
+
+            if (handle) {
+                // Wait without reaping, so the handle never signals a reused pid
+                siginfo_t info;
+                while (waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {}
+                handle->exited();
+            }
+            int status = 0;
+            int waitedFor;
+            while ((waitedFor = waitpid(pid, &status, 0)) < 0 && errno == EINTR) {}
+            {
+                std::lock_guard<std::mutex> lk(waited().m);
+                waited().pids.erase(pid);
+            }
+            if (waitedFor < 0) return finish(handle, -1);
+            return finish(handle, WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+#endif
+        }
+
+#ifndef _WIN32
+        // Reaps `pid`, a zombie child, unless spawn() is waiting on it. For
+        // SessionTracker, which inherits orphans as the subreaper; false when
+        // the zombie was left to spawn().
+        static bool reapUnlessWaited(pid_t pid) {
+            std::lock_guard<std::mutex> lk(waited().m);
+            if (waited().pids.count(pid)) return false;
+            waitpid(pid, nullptr, WNOHANG);
+            return true;
+        }
+#endif
+
+        // Short commands the user is waiting on can go to the Interactive lane;
+        // the default is the lane meant for children that run for a long time.
+        // onComplete always runs: with -1 on the calling thread if the task
+        // cannot be queued (shutting down). Pass `handle` to have it before
+        // the child can start, e.g. to register it somewhere first.
+        static std::shared_ptr<ProcessHandle> spawnAsync(std::vector<std::string> argv, std::function<void(int)> onComplete,
+                                                         LineCallback onOutput = nullptr, const std::string& workingDir = "",
+                                                         Executor::Lane lane = Executor::Process,
+                                                         std::shared_ptr<ProcessHandle> handle = nullptr) {
+            if (!handle) handle = std::make_shared<ProcessHandle>();
+            bool queued = Executor::instance().submit(lane, [=, argv = std::move(argv)]() {
+                int result = spawn(argv, onOutput, workingDir, nullptr, handle.get());
+                if (onComplete) onComplete(result);
+            });
+            if (!queued) {
+                handle->finish(-1);
+                if (onComplete) onComplete(-1);
+            }
+            return handle;
+        }
+
+    private:
+#ifndef _WIN32
+        // Children spawn() reaps itself
+        struct Waited {
+            std::mutex m;
+            std::set<pid_t> pids;
+        };
+        static Waited& waited() {
+            static Waited inst;
+            return inst;
+        }
+#endif
+
+        static int finish(ProcessHandle* handle, int code) {
+            if (handle) handle->finish(code);
+            return code;
+        }
 
 #ifdef _WIN32
-        static int run(const std::string& command, OutputCallback callback = nullptr, const std::string& workingDir = "") {
+        static int runProcess(const std::string& command, OutputCallback callback, const std::string& workingDir,
+                              ProcessHandle* handle) {
+            if (handle && !handle->startable()) return finish(handle, -1);
             SECURITY_ATTRIBUTES saAttr;
             saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
             saAttr.bInheritHandle = TRUE;
@@ -31,11 +418,11 @@ namespace MultiLauncher {
             HANDLE hChildStd_OUT_Wr = NULL;
 
             if (!CreatePipe(&hChildStd_OUT_Rd, &hChildStd_OUT_Wr, &saAttr, 0)) {
-                return -1;
+                return finish(handle, -1);
             }
 
             if (!SetHandleInformation(hChildStd_OUT_Rd, HANDLE_FLAG_INHERIT, 0)) {
-                return -1;
+                return finish(handle, -1);
             }
 
             STARTUPINFOA si = { 0 };
@@ -47,7 +434,9 @@ namespace MultiLauncher {
             PROCESS_INFORMATION pi = { 0 };
             char* cmd = _strdup(command.c_str());
 
-            BOOL bSuccess = CreateProcessA(NULL, cmd, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, 
+            // Suspended until it is in the job, so its own children land there too
+            DWORD flags = CREATE_NO_WINDOW | (handle ? CREATE_SUSPENDED : 0);
+            BOOL bSuccess = CreateProcessA(NULL, cmd, NULL, NULL, TRUE, flags, NULL, 
                                          workingDir.empty() ? NULL : workingDir.c_str(), &si, &pi);
             
             free(cmd);
@@ -55,7 +444,13 @@ namespace MultiLauncher {
             if (!bSuccess) {
                 CloseHandle(hChildStd_OUT_Wr);
                 CloseHandle(hChildStd_OUT_Rd);
-                return -1;
+                return finish(handle, -1);
+            }
+            if (handle) {
+                HANDLE job = CreateJobObjectA(NULL, NULL);
+                if (job) AssignProcessToJobObject(job, pi.hProcess);
+                if (!handle->attach(job)) TerminateProcess(pi.hProcess, 1);
+                ResumeThread(pi.hThread);
             }
 
             CloseHandle(hChildStd_OUT_Wr);
@@ -83,6 +478,7 @@ namespace MultiLauncher {
             }
 
             WaitForSingleObject(pi.hProcess, INFINITE);
+            if (handle) handle->exited();
             DWORD exitCode;
             GetExitCodeProcess(pi.hProcess, &exitCode);
 
@@ -90,45 +486,56 @@ namespace MultiLauncher {
             CloseHandle(pi.hThread);
             CloseHandle(hChildStd_OUT_Rd);
 
-            return (int)exitCode;
-            return (int)exitCode;
+            return finish(handle, (int)exitCode);
         }
-#else
-        static int run(const std::string& command, OutputCallback callback = nullptr, const std::string& workingDir = "") {
-            std::string finalCmd = command;
-            if (!workingDir.empty()) {
-                finalCmd = "cd \"" + workingDir + "\" && " + command;
+#endif
+#ifndef _WIN32
+        // Cuts a pipe's byte stream into lines in place: callbacks get views
+        // into the read buffer, only an unfinished line is moved to the front
+        class LineSplitter {
+        public:
+            explicit LineSplitter(const LineCallback& cb) : cb_(cb), buf_(new char[ReadSize]) {}
+
+            // False at end of stream or on error
+            bool readFrom(int fd) {
+                ssize_t n = read(fd, buf_.get() + used_, ReadSize - used_);
+                if (n < 0 && (errno == EINTR || errno == EAGAIN)) return true;
+                if (n <= 0) return false;
+                size_t end = used_ + (size_t)n;
+                size_t start = 0;
+                for (size_t nl; (nl = find(start, end)) != end; start = nl + 1) {
+                    emit(start, nl);
+                }
+                if (start == 0 && end == ReadSize) {
+                    // longer than the buffer: deliver what we have
+                    emit(0, end);
+                    start = end;
+                }
+                used_ = end - start;
+                if (used_ && start) std::memmove(buf_.get(), buf_.get() + start, used_);
+                return true;
             }
-            // Redirect stderr to stdout
-            finalCmd += " 2>&1";
 
-            std::array<char, 128> buffer;
-            std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(finalCmd.c_str(), "r"), pclose);
-            if (!pipe) {
-                return -1;
+            void finish() {
+                if (used_) emit(0, used_);
+                used_ = 0;
             }
 
-            while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-                std::string line(buffer.data());
-                while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
-                    line.pop_back();
-                }
-                if (callback) callback(line);
+        private:
+            const LineCallback& cb_;
+            std::unique_ptr<char[]> buf_;
+            size_t used_ = 0;
+
+            size_t find(size_t from, size_t end) const {
+                const void* nl = std::memchr(buf_.get() + from, '\n', end - from);
+                return nl ? (size_t)((const char*)nl - buf_.get()) : end;
             }
-            
-            int returnCode = pclose(pipe.release());
-            if (WIFEXITED(returnCode)) {
-                return WEXITSTATUS(returnCode);
+
+            void emit(size_t from, size_t to) {
+                if (to > from && buf_[to - 1] == '\r') to--;
+                if (cb_) cb_(std::string_view(buf_.get() + from, to - from));
             }
-            return -1;
-        }
+        };
 #endif
-
-        static void runAsync(const std::string& command, std::function<void(int)> onComplete, OutputCallback callback = nullptr, const std::string& workingDir = "") {
-            std::thread([=]() {
-                int result = run(command, callback, workingDir);
-                if (onComplete) onComplete(result);
-            }).detach();
-        }
     };
 }
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace MultiLauncher {
+
+    // The process table at one point in time, indexed by lowercased executable
+    // basename. GameManager takes one per tick and every game queries it, so
+    // /proc is walked once per tick instead of once per game.
+    class ProcessSnapshot {
+    public:
+        // `procRoot` is only meant for benchmarks against a fake /proc
+        static ProcessSnapshot capture(const std::filesystem::path& procRoot = "/proc") {
+            ProcessSnapshot snap;
+#ifdef _WIN32
+            (void)procRoot;
+            HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+            if (hSnapshot == INVALID_HANDLE_VALUE) return snap;
+            PROCESSENTRY32W pe32;
+            pe32.dwSize = sizeof(PROCESSENTRY32W);
+            if (Process32FirstW(hSnapshot, &pe32)) {
+                char name[MAX_PATH * 3];
+                do {
+                    int len = WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1, name, sizeof(name), NULL, NULL);
+                    if (len > 1) snap.add(std::string_view(name, len - 1), (int)pe32.th32ProcessID);
+                } while (Process32NextW(hSnapshot, &pe32));
+            }
+            CloseHandle(hSnapshot);
+#else
+            DIR* dir = opendir(procRoot.c_str());
+            if (dir == nullptr) return snap;
+            int rootFd = dirfd(dir);
+
+            char path[64];
+            char cmdline[4096];
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN) continue;
+                int pid = 0;
+                const char* c = entry->d_name;
+                for (; *c >= '0' && *c <= '9'; ++c) pid = pid * 10 + (*c - '0');
+                if (*c || c == entry->d_name) continue;
+
+                std::snprintf(path, sizeof(path), "%d/cmdline", pid);
+                int fd = openat(rootFd, path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) continue; // exited since readdir
+                ssize_t n = ::read(fd, cmdline, sizeof(cmdline));
+                ::close(fd);
+                if (n <= 0) continue; // kernel threads have an empty cmdline
+
+                // argv[0] only
+                std::string_view exe(cmdline, (size_t)n);
+                size_t nul = exe.find('\0');
+                if (nul != std::string_view::npos) exe = exe.substr(0, nul);
+                snap.add(exe, pid);
+            }
+            closedir(dir);
+#endif
+            return snap;
+        }
+
+        // Case-insensitive match against executable basenames
+        bool contains(std::string_view exeName) const {
+            return byName.count(lower(exeName)) != 0;
+        }
+
+        std::vector<int> pids(std::string_view exeName) const {
+            auto it = byName.find(lower(exeName));
+            return it != byName.end() ? it->second : std::vector<int>();
+        }
+
+        size_t processCount() const { return count; }
+
+        // The key form used for lookups (ASCII lowercase)
+        static std::string lower(std::string_view s) {
+            std::string out(s);
+            for (char& c : out) {
+                if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+            }
+            return out;
+        }
+
+    private:
+        std::unordered_map<std::string, std::vector<int> > byName;
+        size_t count = 0;
+
+        void add(std::string_view exe, int pid) {
+            // Wine/Proton processes report Windows paths
+            size_t slash = exe.find_last_of("/\\");
+            if (slash != std::string_view::npos) exe = exe.substr(slash + 1);
+            if (exe.empty()) return;
+            byName[lower(exe)].push_back(pid);
+            count++;
+        }
+    };
+
+}
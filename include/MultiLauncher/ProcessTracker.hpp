@@ -0,0 +1,315 @@
+#pragma once
+#include "Logger.hpp"
+#include "ProcessSnapshot.hpp"
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#endif
+
+namespace MultiLauncher {
+
+    // Decides when game processes need to be checked again, so GameManager
+    // does not have to walk the process table on a fixed timer.
+    //
+    // On Linux it follows:
+    //  - the pids of running games through pidfds, so exits are seen at once;
+    //  - exec/exit events from the proc connector (netlink), when the process
+    //    is allowed to subscribe (usually needs CAP_NET_ADMIN), so starts are
+    //    seen at once too.
+    // Otherwise, and on other platforms, it falls back to a timer whose
+    // interval the caller adapts (fast while a game is launching).
+    //
+    // The callback runs on the tracker thread and returns the next interval.
+    class ProcessTracker {
+    public:
+        using Callback = std::function<std::chrono::milliseconds()>;
+
+        // Exec events are bursty (shell scripts, compilers); checks run at most this often
+        static constexpr std::chrono::milliseconds MinGap{100};
+
+        ProcessTracker() = default;
+        ProcessTracker(const ProcessTracker&) = delete;
+        ProcessTracker& operator=(const ProcessTracker&) = delete;
+        ~ProcessTracker() { stop(); }
+
+        void start(Callback cb) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (running_) return;
+            callback_ = std::move(cb);
+            running_ = true;
+#ifdef __linux__
+            wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            netlinkFd_ = openProcConnector();
+            Logger::instance().info(netlinkFd_ >= 0
+                ? "Process tracking: using proc connector events"
+                : "Process tracking: proc connector unavailable, polling");
+#endif
+            thread_ = std::thread([this]() { loop(); });
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (!running_) return;
+                running_ = false;
+            }
+            wake();
+            if (thread_.joinable()) thread_.join();
+#ifdef __linux__
+            for (const auto& [pid, fd] : pidfds_) close(fd);
+            pidfds_.clear();
+            if (netlinkFd_ >= 0) close(netlinkFd_);
+            netlinkFd_ = -1;
+            {
+                // wake() may be writing to it from another thread
+                std::lock_guard<std::mutex> lk(m_);
+                if (wakeFd_ >= 0) close(wakeFd_);
+                wakeFd_ = -1;
+            }
+#endif
+        }
+
+        // Runs the callback as soon as possible, e.g. right after a launch
+        void wake() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+#ifdef __linux__
+                uint64_t one = 1;
+                if (wakeFd_ >= 0) (void)!write(wakeFd_, &one, sizeof(one));
+#endif
+                woken_ = true;
+            }
+            cv_.notify_all();
+        }
+
+        // Pids whose exit should trigger a check (the running games)
+        void watchPids(const std::vector<int>& pids) {
+            std::lock_guard<std::mutex> lk(m_);
+            wantedPids_.assign(pids.begin(), pids.end());
+        }
+
+        // Lowercased executable basenames whose exec should trigger a check
+        void watchNames(std::unordered_set<std::string> names) {
+            std::lock_guard<std::mutex> lk(m_);
+            names_ = std::move(names);
+        }
+
+        // True when starts are reported by events instead of the timer
+        bool eventDriven() const {
+#ifdef __linux__
+            return netlinkFd_ >= 0;
+#else
+            return false;
+#endif
+        }
+
+    private:
+        std::mutex m_;
+        std::condition_variable cv_;
+        Callback callback_;
+        bool running_ = false;
+        bool woken_ = false;
+        std::thread thread_;
+        std::vector<int> wantedPids_;
+        std::unordered_set<std::string> names_;
+
+        void loop() {
+            using clock = std::chrono::steady_clock;
+            std::chrono::milliseconds interval{0}; // check once right away
+            clock::time_point lastCheck;
+            bool due = true;
+
+            while (true) {
+                auto now = clock::now();
+                if (due && now - lastCheck >= MinGap) {
+                    due = false;
+                    lastCheck = now;
+                    if (callback_) interval = callback_();
+#ifdef __linux__
+                    syncPidfds();
+#endif
+                    continue;
+                }
+                auto timeout = due ? MinGap - (now - lastCheck) : interval - (now - lastCheck);
+                int timeoutMs = (int)std::max<long long>(0,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count());
+
+                bool event = waitForEvent(timeoutMs);
+                {
+                    std::lock_guard<std::mutex> lk(m_);
+                    if (!running_) return;
+                    if (woken_) event = true;
+                    woken_ = false;
+                }
+                if (event || clock::now() - lastCheck >= interval) due = true;
+            }
+        }
+
+#ifdef __linux__
+        int wakeFd_ = -1;
+        int netlinkFd_ = -1;
+        std::unordered_map<int, int> pidfds_; // pid -> pidfd
+
+        static int pidfdOpen(int pid) {
+#if defined(SYS_pidfd_open)
+            return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+            return (int)syscall(434, pid, 0); // __NR_pidfd_open, same on every arch
+#endif
+        }
+
+        // Opens a pidfd for every newly wanted pid and drops the others
+        void syncPidfds() {
+            std::vector<int> wanted;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                wanted = wantedPids_;
+            }
+            std::unordered_set<int> keep(wanted.begin(), wanted.end());
+            for (auto it = pidfds_.begin(); it != pidfds_.end();) {
+                if (!keep.count(it->first)) {
+                    close(it->second);
+                    it = pidfds_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (int pid : wanted) {
+                if (pidfds_.count(pid)) continue;
+                int fd = pidfdOpen(pid);
+                if (fd >= 0) pidfds_.emplace(pid, fd); // ENOSYS before 5.3: the timer covers it
+            }
+        }
+
+        static int openProcConnector() {
+            int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_CONNECTOR);
+            if (fd < 0) return -1;
+            sockaddr_nl addr = {};
+            addr.nl_family = AF_NETLINK;
+            addr.nl_groups = CN_IDX_PROC;
+            if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+                close(fd);
+                return -1;
+            }
+
+            // nlmsghdr | cn_msg | op, built by hand (cn_msg ends in a flexible array)
+            constexpr size_t len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+            alignas(nlmsghdr) char msg[len] = {};
+            auto* nl = (nlmsghdr*)msg;
+            nl->nlmsg_len = len;
+            nl->nlmsg_type = NLMSG_DONE;
+            auto* cn = (cn_msg*)NLMSG_DATA(nl);
+            cn->id.idx = CN_IDX_PROC;
+            cn->id.val = CN_VAL_PROC;
+            cn->len = sizeof(proc_cn_mcast_op);
+            proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+            std::memcpy(cn->data, &op, sizeof(op));
+            if (send(fd, msg, len, 0) != (ssize_t)len) {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        bool waitForEvent(int timeoutMs) {
+            std::vector<pollfd> fds;
+            fds.reserve(2 + pidfds_.size());
+            fds.push_back({ wakeFd_, POLLIN, 0 });
+            if (netlinkFd_ >= 0) fds.push_back({ netlinkFd_, POLLIN, 0 });
+            size_t firstPid = fds.size();
+            for (const auto& [pid, fd] : pidfds_) fds.push_back({ fd, POLLIN, 0 });
+
+            int n = poll(fds.data(), fds.size(), timeoutMs);
+            if (n <= 0) return false;
+
+            bool event = false;
+            if (fds[0].revents & POLLIN) {
+                uint64_t value;
+                (void)!read(wakeFd_, &value, sizeof(value));
+                event = true;
+            }
+            if (netlinkFd_ >= 0 && fds[1].revents) {
+                // POLLERR means ENOBUFS: events were dropped, check anyway
+                if (readProcEvents() || (fds[1].revents & POLLERR)) event = true;
+            }
+            for (size_t i = firstPid; i < fds.size(); ++i) {
+                if (!fds[i].revents) continue;
+                // readable once the process exited, and stays readable
+                event = true;
+                close(fds[i].fd);
+                std::erase_if(pidfds_, [&](const auto& p) { return p.second == fds[i].fd; });
+            }
+            return event;
+        }
+
+        // Drains the connector; true if any event concerns a tracked pid or name
+        bool readProcEvents() {
+            alignas(nlmsghdr) char buf[8192];
+            bool relevant = false;
+            ssize_t len;
+            while ((len = recv(netlinkFd_, buf, sizeof(buf), 0)) > 0 || (len < 0 && errno == ENOBUFS)) {
+                if (len < 0) continue;
+                for (auto* nl = (nlmsghdr*)buf; NLMSG_OK(nl, (size_t)len); nl = NLMSG_NEXT(nl, len)) {
+                    if (nl->nlmsg_type == NLMSG_ERROR || nl->nlmsg_type == NLMSG_NOOP) continue;
+                    auto* cn = (cn_msg*)NLMSG_DATA(nl);
+                    if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC) continue;
+                    auto* ev = (proc_event*)cn->data;
+                    if (ev->what == proc_event::PROC_EVENT_EXEC) {
+                        if (ev->event_data.exec.process_pid == ev->event_data.exec.process_tgid &&
+                            execMatches(ev->event_data.exec.process_tgid)) relevant = true;
+                    } else if (ev->what == proc_event::PROC_EVENT_EXIT) {
+                        int pid = ev->event_data.exit.process_tgid;
+                        if (ev->event_data.exit.process_pid == pid && pidfds_.count(pid)) relevant = true;
+                    }
+                }
+            }
+            return relevant;
+        }
+
+        // Reads argv[0] of a freshly exec'd process and compares its basename
+        bool execMatches(int pid) {
+            char path[64];
+            std::snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+            int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            char cmdline[4096];
+            ssize_t n = read(fd, cmdline, sizeof(cmdline));
+            close(fd);
+            if (n <= 0) return false;
+            std::string_view exe(cmdline, strnlen(cmdline, (size_t)n));
+            size_t slash = exe.find_last_of("/\\");
+            if (slash != std::string_view::npos) exe = exe.substr(slash + 1);
+            std::string name = ProcessSnapshot::lower(exe);
+            std::lock_guard<std::mutex> lk(m_);
+            return names_.count(name) != 0;
+        }
+#else
+        bool waitForEvent(int timeoutMs) {
+            std::unique_lock<std::mutex> lk(m_);
+            return cv_.wait_for(lk, std::chrono::milliseconds(timeoutMs), [this]() { return woken_ || !running_; });
+        }
+#endif
+    };
+
+}
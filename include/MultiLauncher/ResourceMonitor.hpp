@@ -0,0 +1,342 @@
+#pragma once
+#include "Logger.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+namespace MultiLauncher {
+
+    // Fixed-size history in the layout ImGui::PlotLines expects (values + offset)
+    template <size_t N>
+    class RingBuffer {
+    public:
+        void push(float v) {
+            data_[next_] = v;
+            next_ = (next_ + 1) % N;
+            if (count_ < N) count_++;
+        }
+        const float* data() const { return data_.data(); }
+        int size() const { return (int)count_; }
+        // Index of the oldest value once the buffer has wrapped
+        int offset() const { return count_ < N ? 0 : (int)next_; }
+
+    private:
+        std::array<float, N> data_ = {};
+        size_t next_ = 0;
+        size_t count_ = 0;
+    };
+
+    // Totals over a game's process tree at one sample
+    struct ResourceSample {
+        float cpuPercent = 0;   // of one core, so 250 means two and a half cores busy
+        uint64_t rssBytes = 0;
+        int threads = 0;
+        int processes = 0;
+        float readBytesPerSec = 0;
+        float writeBytesPerSec = 0;
+        bool hasIo = false;     // /proc/<pid>/io is not readable for every process
+    };
+
+    struct ResourceHistory {
+        static constexpr size_t Length = 120;
+        ResourceSample latest;
+        RingBuffer<Length> cpu;
+        RingBuffer<Length> rssMb;
+        RingBuffer<Length> readMbps;
+        RingBuffer<Length> writeMbps;
+    };
+
+    // Samples CPU, memory, threads and disk I/O of running games from /proc.
+    //
+    // GameManager::update reports the pids of every running game's executable;
+    // the monitor follows their descendants (task/*/children) and keeps the
+    // stat, statm and io files of each process open, re-reading them with
+    // pread at a fixed interval. The thread sleeps while no game is running.
+    class ResourceMonitor {
+    public:
+        static constexpr std::chrono::milliseconds Interval{1000};
+        // Samples between looking for new child processes
+        static constexpr int TreeRefresh = 5;
+        // Keeps the fd count bounded for games that spawn a lot of processes
+        static constexpr size_t MaxProcesses = 256;
+
+        static ResourceMonitor& instance() {
+            static ResourceMonitor inst;
+            return inst;
+        }
+
+        // Running games by name with the pids of their executable. Games not
+        // listed any more stop being sampled and their history is dropped.
+        void watch(std::map<std::string, std::vector<int> > roots) {
+#ifdef __linux__
+            std::lock_guard<std::mutex> lk(m_);
+            for (auto it = history_.begin(); it != history_.end();) {
+                if (!roots.count(it->first)) it = history_.erase(it);
+                else ++it;
+            }
+            bool wasIdle = roots_.empty();
+            roots_ = std::move(roots);
+            if (roots_.empty()) return;
+            if (!thread_.joinable()) thread_ = std::thread([this]() { loop(); });
+            if (wasIdle) cv_.notify_all();
+#else
+            (void)roots;
+#endif
+        }
+
+        // Empty until the second sample of a running game
+        std::optional<ResourceHistory> history(const std::string& game) const {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = history_.find(game);
+            if (it == history_.end()) return std::nullopt;
+            return it->second;
+        }
+
+    private:
+        ResourceMonitor() = default;
+        ~ResourceMonitor() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        mutable std::mutex m_;
+        std::condition_variable cv_;
+        std::map<std::string, std::vector<int> > roots_;
+        std::map<std::string, ResourceHistory> history_;
+        std::thread thread_;
+        bool stopping_ = false;
+
+#ifdef __linux__
+        struct Proc {
+            int stat = -1;
+            int statm = -1;
+            int io = -1;
+            uint64_t ticks = 0;
+            uint64_t readBytes = 0;
+            uint64_t writeBytes = 0;
+            bool sampled = false;
+        };
+        // Sampler thread only
+        struct Tree {
+            std::vector<int> roots;
+            std::unordered_map<int, Proc> procs;
+            int sinceRefresh = 0;
+            std::chrono::steady_clock::time_point lastSample;
+        };
+        std::map<std::string, Tree> trees_;
+
+        void loop() {
+            std::unique_lock<std::mutex> lk(m_);
+            while (!stopping_) {
+                if (roots_.empty()) {
+                    // nothing running: drop the fds and sleep until watch()
+                    lk.unlock();
+                    for (auto& [_, tree] : trees_) closeAll(tree);
+                    trees_.clear();
+                    lk.lock();
+                    cv_.wait(lk, [this]() { return stopping_ || !roots_.empty(); });
+                    continue;
+                }
+                auto roots = roots_;
+                lk.unlock();
+
+                std::map<std::string, ResourceSample> samples;
+                for (auto it = trees_.begin(); it != trees_.end();) {
+                    if (!roots.count(it->first)) {
+                        closeAll(it->second);
+                        it = trees_.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+                for (auto& [game, pids] : roots) {
+                    Tree& tree = trees_[game];
+                    if (tree.roots != pids || --tree.sinceRefresh <= 0) {
+                        tree.roots = pids;
+                        tree.sinceRefresh = TreeRefresh;
+                        refreshTree(tree);
+                    }
+                    if (auto s = sample(tree)) samples.emplace(game, *s);
+                }
+
+                lk.lock();
+                for (auto& [game, s] : samples) {
+                    if (!roots_.count(game)) continue;
+                    ResourceHistory& h = history_[game];
+                    h.latest = s;
+                    h.cpu.push(s.cpuPercent);
+                    h.rssMb.push((float)(s.rssBytes / (1024.0 * 1024.0)));
+                    h.readMbps.push(s.readBytesPerSec / (1024.0f * 1024.0f));
+                    h.writeMbps.push(s.writeBytesPerSec / (1024.0f * 1024.0f));
+                }
+                cv_.wait_for(lk, Interval, [this]() { return stopping_; });
+            }
+        }
+
+        static void closeProc(Proc& p) {
+            if (p.stat >= 0) close(p.stat);
+            if (p.statm >= 0) close(p.statm);
+            if (p.io >= 0) close(p.io);
+            p.stat = p.statm = p.io = -1;
+        }
+
+        static void closeAll(Tree& tree) {
+            for (auto& [_, p] : tree.procs) closeProc(p);
+            tree.procs.clear();
+        }
+
+        // The roots and all their descendants, through every thread's children list
+        static std::unordered_set<int> descendants(const std::vector<int>& roots) {
+            std::unordered_set<int> seen;
+            std::vector<int> queue(roots.begin(), roots.end());
+            char path[64];
+            char buf[4096];
+            while (!queue.empty() && seen.size() < MaxProcesses) {
+                int pid = queue.back();
+                queue.pop_back();
+                if (!seen.insert(pid).second) continue;
+                std::snprintf(path, sizeof(path), "/proc/%d/task", pid);
+                DIR* dir = opendir(path);
+                if (dir == nullptr) continue;
+                struct dirent* entry;
+                while ((entry = readdir(dir)) != nullptr) {
+                    if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+                    std::snprintf(path, sizeof(path), "/proc/%d/task/%.16s/children", pid, entry->d_name);
+                    int fd = open(path, O_RDONLY | O_CLOEXEC);
+                    if (fd < 0) continue; // kernel without CONFIG_PROC_CHILDREN: roots only
+                    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+                    close(fd);
+                    if (n <= 0) continue;
+                    buf[n] = '\0';
+                    char* p = buf;
+                    while (true) {
+                        char* end;
+                        long child = std::strtol(p, &end, 10);
+                        if (end == p) break;
+                        queue.push_back((int)child);
+                        p = end;
+                    }
+                }
+                closedir(dir);
+            }
+            return seen;
+        }
+
+        static void refreshTree(Tree& tree) {
+            auto pids = descendants(tree.roots);
+            for (auto it = tree.procs.begin(); it != tree.procs.end();) {
+                if (!pids.count(it->first)) {
+                    closeProc(it->second);
+                    it = tree.procs.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            char path[64];
+            for (int pid : pids) {
+                if (tree.procs.count(pid)) continue;
+                Proc p;
+                std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+                p.stat = open(path, O_RDONLY | O_CLOEXEC);
+                if (p.stat < 0) continue;
+                std::snprintf(path, sizeof(path), "/proc/%d/statm", pid);
+                p.statm = open(path, O_RDONLY | O_CLOEXEC);
+                std::snprintf(path, sizeof(path), "/proc/%d/io", pid);
+                p.io = open(path, O_RDONLY | O_CLOEXEC); // EACCES for setuid helpers
+                tree.procs.emplace(pid, p);
+            }
+        }
+
+        static ssize_t readAt(int fd, char* buf, size_t size) {
+            if (fd < 0) return -1;
+            ssize_t n = pread(fd, buf, size - 1, 0);
+            if (n >= 0) buf[n] = '\0';
+            return n;
+        }
+
+        // Sums the tree; processes that exited are dropped (their fds now fail with ESRCH)
+        static std::optional<ResourceSample> sample(Tree& tree) {
+            static const long ticksPerSec = sysconf(_SC_CLK_TCK);
+            static const long pageSize = sysconf(_SC_PAGESIZE);
+
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - tree.lastSample).count();
+            bool rates = tree.lastSample != std::chrono::steady_clock::time_point{};
+            tree.lastSample = now;
+
+            ResourceSample s;
+            uint64_t ticks = 0, readBytes = 0, writeBytes = 0;
+            char buf[1024];
+            for (auto it = tree.procs.begin(); it != tree.procs.end();) {
+                Proc& p = it->second;
+                // "pid (comm) state ppid ... utime stime ... num_threads"; comm may contain spaces
+                const char* rp = readAt(p.stat, buf, sizeof(buf)) > 0 ? std::strrchr(buf, ')') : nullptr;
+                char state;
+                unsigned long long utime, stime;
+                long threads;
+                if (!rp || std::sscanf(rp + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %ld",
+                                       &state, &utime, &stime, &threads) != 4 || state == 'Z') {
+                    closeProc(p);
+                    it = tree.procs.erase(it);
+                    continue;
+                }
+                s.processes++;
+                s.threads += (int)threads;
+                uint64_t procTicks = utime + stime;
+                if (p.sampled && procTicks >= p.ticks) ticks += procTicks - p.ticks;
+                p.ticks = procTicks;
+
+                unsigned long long size, resident;
+                if (readAt(p.statm, buf, sizeof(buf)) > 0 && std::sscanf(buf, "%llu %llu", &size, &resident) == 2) {
+                    s.rssBytes += resident * (uint64_t)pageSize;
+                }
+
+                if (readAt(p.io, buf, sizeof(buf)) > 0) {
+                    const char* r = std::strstr(buf, "\nread_bytes:");
+                    const char* w = std::strstr(buf, "\nwrite_bytes:");
+                    if (r && w) {
+                        uint64_t rb = std::strtoull(r + 12, nullptr, 10);
+                        uint64_t wb = std::strtoull(w + 13, nullptr, 10);
+                        if (p.sampled && rb >= p.readBytes) readBytes += rb - p.readBytes;
+                        if (p.sampled && wb >= p.writeBytes) writeBytes += wb - p.writeBytes;
+                        p.readBytes = rb;
+                        p.writeBytes = wb;
+                        s.hasIo = true;
+                    }
+                }
+                p.sampled = true;
+                ++it;
+            }
+            if (!rates || elapsed <= 0 || s.processes == 0) return std::nullopt;
+            s.cpuPercent = (float)(ticks * 100.0 / ((double)ticksPerSec * elapsed));
+            s.readBytesPerSec = (float)(readBytes / elapsed);
+            s.writeBytesPerSec = (float)(writeBytes / elapsed);
+            return s;
+        }
+#else
+        void loop() {}
+#endif
+    };
+
+}
@@ -0,0 +1,330 @@
+#pragma once
+#include "Logger.hpp"
+#include "ProcessSnapshot.hpp"
+#include "ProcessRunner.hpp"
+#include <string>
+#include <string_view>
+#include <map>
+#include <optional>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#endif
+
+namespace MultiLauncher {
+
+    struct LaunchSession {
+        std::string game;
+        std::chrono::system_clock::time_point start;
+        std::chrono::system_clock::time_point end;  // equals start while running
+        int processes = 0;      // at the last check
+        int peakProcesses = 0;
+        bool gameSeen = false;  // the game's executable actually ran
+        bool detected = false;  // bounded by executable detection, not by a process tree we own
+
+        int minutes() const {
+            auto last = end > start ? end : std::chrono::system_clock::now();
+            return (int)std::chrono::duration_cast<std::chrono::minutes>(last - start).count();
+        }
+    };
+
+    // Play sessions, one per game name.
+    //
+    // Games we start ourselves (Game::launch on Linux) run in their own
+    // session (setsid), so every descendant carries the root's session id
+    // even after its parent exits. The tracker counts those processes and
+    // the session ends when the last one is gone. With enable() the
+    // launcher is the child subreaper, so orphaned descendants are
+    // reparented to us and reaped here instead of escaping to init.
+    //
+    // When the tree we own exits before the game's executable showed up
+    // (xdg-open handing steam:// to the running Steam client), the session
+    // is handed over to executable detection: GameManager reports
+    // detectedRunning/detectedStopped from its process checks. Games
+    // started outside the launcher are tracked the same way.
+    class SessionTracker {
+    public:
+        using EndCallback = std::function<void(const LaunchSession&)>;
+
+        static constexpr std::chrono::milliseconds Tick{1000};
+        // How long a handed-over launch may take to show its executable
+        static constexpr std::chrono::seconds HandoffTimeout{120};
+
+        static SessionTracker& instance() {
+            static SessionTracker inst;
+            return inst;
+        }
+
+        // Makes this process the subreaper for everything it launches
+        bool enable() {
+#ifdef __linux__
+            if (prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0) != 0) {
+                Logger::instance().error("Session tracking: PR_SET_CHILD_SUBREAPER failed, orphaned game processes are not reaped");
+                return false;
+            }
+            std::lock_guard<std::mutex> lk(m_);
+            if (!thread_.joinable()) thread_ = std::thread([this]() { loop(); });
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Follows the process tree of `pid`, which must have called setsid().
+        // onEnd runs once, on the tracker thread, when the session is over.
+        void track(int pid, const std::string& game, const std::string& exeName, EndCallback onEnd) {
+            std::lock_guard<std::mutex> lk(m_);
+            Entry& e = sessions_[game];
+            e = {};
+            e.session.game = game;
+            e.session.start = e.session.end = std::chrono::system_clock::now();
+            e.session.processes = e.session.peakProcesses = 1;
+            e.state = Entry::Owned;
+            e.root = pid;
+            e.exe = ProcessSnapshot::lower(exeName);
+            e.onEnd = std::move(onEnd);
+            if (!thread_.joinable()) thread_ = std::thread([this]() { loop(); });
+            cv_.notify_all();
+        }
+
+        // The game's executable is running with `processes` instances. onEnd
+        // replaces the launch's callback when a handed-over launch shows up.
+        void detectedRunning(const std::string& game, int processes, EndCallback onEnd) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto [it, created] = sessions_.try_emplace(game);
+            Entry& e = it->second;
+            if (created) {
+                e.session.game = game;
+                e.session.start = e.session.end = std::chrono::system_clock::now();
+            }
+            if (e.state == Entry::Owned && !created) {
+                // Counted by the tree walk, unless the game is running outside our tree
+                e.runningElsewhere = true;
+                e.detectedOnEnd = std::move(onEnd);
+                return;
+            }
+            if (e.state != Entry::Detected || created) e.onEnd = std::move(onEnd);
+            e.state = Entry::Detected;
+            e.session.detected = true;
+            e.session.gameSeen = true;
+            e.session.processes = processes;
+            e.session.peakProcesses = std::max(e.session.peakProcesses, processes);
+        }
+
+        void detectedStopped(const std::string& game) {
+            std::unique_lock<std::mutex> lk(m_);
+            auto it = sessions_.find(game);
+            if (it == sessions_.end()) return;
+            if (it->second.state == Entry::Owned) it->second.runningElsewhere = false;
+            if (it->second.state != Entry::Detected) return;
+            finish(it, lk);
+        }
+
+        std::optional<LaunchSession> active(const std::string& game) const {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = sessions_.find(game);
+            if (it == sessions_.end() || it->second.state == Entry::Handoff) return std::nullopt;
+            return it->second.session;
+        }
+
+    private:
+        struct Entry {
+            enum State { Owned, Handoff, Detected };
+            LaunchSession session;
+            State state = Detected;
+            int root = 0;         // session id of an owned tree
+            std::string exe;      // lowercased basename looked for in an owned tree
+            std::chrono::steady_clock::time_point handoffSince;
+            bool runningElsewhere = false; // detected while our tree was still alive
+            EndCallback onEnd;
+            EndCallback detectedOnEnd;
+        };
+
+        SessionTracker() = default;
+        ~SessionTracker() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        mutable std::mutex m_;
+        std::condition_variable cv_;
+        std::map<std::string, Entry> sessions_;
+        std::thread thread_;
+        bool stopping_ = false;
+
+        // Erases the entry and runs its callback without holding the lock
+        void finish(std::map<std::string, Entry>::iterator it, std::unique_lock<std::mutex>& lk) {
+            LaunchSession session = it->second.session;
+            session.end = std::chrono::system_clock::now();
+            EndCallback onEnd = std::move(it->second.onEnd);
+            sessions_.erase(it);
+            lk.unlock();
+            Logger::instance().info("Session ended: " + session.game + ", " + std::to_string(session.minutes()) +
+                " min, peak " + std::to_string(session.peakProcesses) + " processes" +
+                (session.detected ? " (detected)" : ""));
+            if (onEnd) onEnd(session);
+            lk.lock();
+        }
+
+        void loop() {
+            std::unique_lock<std::mutex> lk(m_);
+            while (!stopping_) {
+                cv_.wait_for(lk, Tick);
+                if (stopping_) return;
+                // zombies queued behind one spawn() has yet to reap are found by the /proc walk
+                bool stuck = !reapOrphans();
+                bool owned = false;
+                for (const auto& [_, e] : sessions_) owned |= e.state == Entry::Owned;
+                if (owned || stuck) {
+                    lk.unlock();
+                    auto trees = walkTrees();
+                    lk.lock();
+                    updateOwned(trees, lk);
+                }
+                auto now = std::chrono::steady_clock::now();
+                for (auto it = sessions_.begin(); it != sessions_.end();) {
+                    auto next = std::next(it);
+                    if (it->second.state == Entry::Handoff && now - it->second.handoffSince > HandoffTimeout) {
+                        Logger::instance().info(it->first + " did not start within " +
+                            std::to_string(HandoffTimeout.count()) + " s of its launch");
+                        std::string key = it->first;
+                        finish(it, lk);
+                        next = sessions_.upper_bound(key);
+                    }
+                    it = next;
+                }
+            }
+        }
+
+        struct Tree {
+            int live = 0;
+            bool exeSeen = false;
+        };
+
+#ifdef __linux__
+        // One /proc walk: live process count per owned session id. Reaps the
+        // zombies this process is responsible for on the way.
+        std::map<int, Tree> walkTrees() {
+            std::map<int, std::string> wanted; // sid -> exe
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                for (const auto& [_, e] : sessions_) {
+                    if (e.state == Entry::Owned) wanted[e.root] = e.exe;
+                }
+            }
+            std::map<int, Tree> trees;
+            for (const auto& [sid, _] : wanted) trees[sid];
+
+            DIR* dir = opendir("/proc");
+            if (dir == nullptr) return trees;
+            int self = getpid();
+            char path[64];
+            char buf[4096];
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                int pid = std::atoi(entry->d_name);
+                if (pid <= 0) continue;
+                std::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+                int fd = open(path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) continue;
+                ssize_t n = read(fd, buf, sizeof(buf) - 1);
+                close(fd);
+                if (n <= 0) continue;
+                buf[n] = '\0';
+                // "pid (comm) state ppid pgrp session ..."; comm may contain spaces
+                const char* rp = std::strrchr(buf, ')');
+                char state;
+                int ppid, pgrp, sid;
+                if (!rp || std::sscanf(rp + 1, " %c %d %d %d", &state, &ppid, &pgrp, &sid) != 4) continue;
+
+                auto tree = trees.find(sid);
+                if (state == 'Z') {
+                    // children spawn() waits on are left to it
+                    if (ppid == self) ProcessRunner::reapUnlessWaited(pid);
+                    continue;
+                }
+                if (tree == trees.end()) continue;
+                tree->second.live++;
+                if (!tree->second.exeSeen) {
+                    std::snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+                    fd = open(path, O_RDONLY | O_CLOEXEC);
+                    if (fd < 0) continue;
+                    n = read(fd, buf, sizeof(buf) - 1);
+                    close(fd);
+                    if (n <= 0) continue;
+                    std::string_view exe(buf, strnlen(buf, (size_t)n));
+                    size_t slash = exe.find_last_of("/\\");
+                    if (slash != std::string_view::npos) exe = exe.substr(slash + 1);
+                    if (ProcessSnapshot::lower(exe) == wanted[sid]) tree->second.exeSeen = true;
+                }
+            }
+            closedir(dir);
+            return trees;
+        }
+
+        // As subreaper we inherit orphans from every tree we start, including
+        // ones that called setsid() themselves, and the workers of a legendary
+        // that exited before them. Peeks at the next zombie child with WNOWAIT
+        // and reaps it unless ProcessRunner::spawn() is waiting on it. waitid
+        // keeps reporting that one first; false means others may be queued
+        // behind it.
+        bool reapOrphans() {
+            while (true) {
+                siginfo_t info = {};
+                if (waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid == 0) return true;
+                if (!ProcessRunner::reapUnlessWaited(info.si_pid)) return false;
+            }
+        }
+#else
+        std::map<int, Tree> walkTrees() { return {}; }
+        bool reapOrphans() { return true; }
+#endif
+
+        void updateOwned(const std::map<int, Tree>& trees, std::unique_lock<std::mutex>& lk) {
+            for (auto it = sessions_.begin(); it != sessions_.end();) {
+                auto next = std::next(it);
+                Entry& e = it->second;
+                auto tree = trees.find(e.root);
+                if (e.state == Entry::Owned && tree != trees.end()) {
+                    e.session.processes = tree->second.live;
+                    e.session.peakProcesses = std::max(e.session.peakProcesses, tree->second.live);
+                    e.session.gameSeen |= tree->second.exeSeen;
+                    if (tree->second.live == 0) {
+                        if (e.session.gameSeen) {
+                            std::string key = it->first;
+                            finish(it, lk);
+                            next = sessions_.upper_bound(key);
+                        } else if (e.runningElsewhere) {
+                            // Handed over and already running
+                            e.state = Entry::Detected;
+                            e.session.detected = e.session.gameSeen = true;
+                            e.onEnd = std::move(e.detectedOnEnd);
+                        } else {
+                            // Launched through another client; wait for the executable
+                            e.state = Entry::Handoff;
+                            e.handoffSince = std::chrono::steady_clock::now();
+                            Logger::instance().info(it->first + ": launch handed over, following the executable");
+                        }
+                    }
+                }
+                it = next;
+            }
+        }
+    };
+
+}
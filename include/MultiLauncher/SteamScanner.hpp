@@ -1,154 +1,284 @@
 #pragma once
 #include "IScanner.hpp"
-#include "../external/ValveFileVDF/vdf_parser.hpp"
-#include <fstream>
-#include <iostream>
+#include "MappedFile.hpp"
+#include "VdfReader.hpp"
 #include "Logger.hpp"
 #include <vector>
 #include <string>
 #include <filesystem>
 #include <optional> // added
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
 
 namespace MultiLauncher {
 
 class SteamScanner : public IScanner {
 public:
+    SteamScanner() = default;
+    // Reads libraries from the given libraryfolders.vdf instead of the
+    // default Steam install (benchmarks, portable installs)
+    explicit SteamScanner(std::filesystem::path libraryFolders) : libraryFoldersOverride(std::move(libraryFolders)) {}
+
+    std::string name() const override { return "Steam"; }
+    Game::LauncherType launcher() const override { return Game::STEAM; }
+
+    // Manifests are only reparsed when their fingerprint changes, so a refresh
+    // with nothing installed or removed costs a readdir + stat per manifest.
+    // forceRefresh does not bypass the cache: the fingerprint already tells us
+    // whether Steam rewrote a file. scan() is never called concurrently on the
+    // same scanner (GameManager serializes it).
     std::vector<Game> scan(bool forceRefresh = false) override {
         std::vector<Game> games;
-#ifdef _WIN32
-        std::ifstream file(R"(C:\Program Files (x86)\Steam\steamapps\libraryfolders.vdf)");
-        if (!file) {
-            Logger::instance().error("Could not open libraryfolders.vdf");
-            return games;
-        }
-#else
-        const char* home_env = std::getenv("HOME");
-        std::filesystem::path home = home_env ? std::filesystem::path(home_env) : ".";
-        std::filesystem::path steam_path = home / ".local/share/Steam/steamapps/libraryfolders.vdf";
-        std::filesystem::path flathub_path = home / ".var/app/com.valvesoftware.Steam/data/Steam/steamapps/libraryfolders.vdf";
 
-        std::ifstream file(steam_path);
-        if (!file.is_open()) {
-            Logger::instance().info("Could not open libraryfolders.vdf at " + steam_path.string() + ", trying flathub");
-            file.open(flathub_path);
-            if (!file.is_open()) {
-                Logger::instance().error("Could not open libraryfolders.vdf at " + flathub_path.string());
-                return games;
-            }
-        }
-#endif
+        auto libraries = libraryPaths();
+        if (!libraries) return games;
 
-        tyti::vdf::object root;
-        try {
-            root = tyti::vdf::read(file);
-        } catch (const std::exception& e) {
-            Logger::instance().error(std::string("Failed to parse libraryfolders.vdf: ") + e.what());
-            return games;
-        }
+        size_t parsed = 0, reused = 0;
+        std::unordered_map<std::string, ManifestEntry> seen;
 
-        Logger::instance().info(std::string("Root name: ") + root.name);
+        for (const auto& lib : *libraries) {
+            std::filesystem::path steamapps = lib / "steamapps";
 
-        // helper: attempt to get "path" from a library object (robust for different VDF shapes)
-        auto get_library_path = [](const tyti::vdf::object& lib) -> std::optional<std::filesystem::path> {
-            // common case: path is an attribute
-            auto it = lib.attribs.find("path");
-            if (it != lib.attribs.end()) return std::filesystem::path(it->second);
+            std::error_code ec;
+            if (!std::filesystem::exists(steamapps, ec)) continue;
 
-            // fallback: path might be represented as a child with an attrib
-            auto cit = lib.childs.find("path");
-            if (cit != lib.childs.end()) {
-                const auto& child = *cit->second;
-                if (!child.attribs.empty()) return std::filesystem::path(child.attribs.begin()->second);
-            }
+            Logger::instance().info(std::string("Steam library found: ") + steamapps.string());
 
-            return std::nullopt;
-        };
+            for (const auto& entry : std::filesystem::directory_iterator(steamapps, ec)) {
+                if (!entry.is_regular_file(ec)) continue;
+                std::string filename = entry.path().filename().string();
+                if (filename.rfind("appmanifest_", 0) != 0 || entry.path().extension() != ".acf")
+                    continue;
+
+                auto fp = fingerprint(entry.path());
+                if (!fp) continue;
 
-        for (const auto& [id, lib_ptr] : root.childs) {
-            const auto& lib = *lib_ptr;
+                std::string key = entry.path().string();
+                auto cached = manifestCache.find(key);
+                ManifestEntry me;
+                if (cached != manifestCache.end() && cached->second.fp == *fp) {
+                    me = std::move(cached->second);
+                    reused++;
+                } else {
+                    me.fp = *fp;
+                    me.app = parseManifest(entry.path());
+                    parsed++;
+                }
 
-            auto opt_path = get_library_path(lib);
-            if (!opt_path.has_value()) {
-                Logger::instance().error(std::string("No path for library id: ") + id);
-                continue;
+                if (me.app) {
+                    games.emplace_back(
+                        me.app->name,
+                        Game::STEAM,
+                        std::filesystem::path("steam://run/" + std::to_string(me.app->appid)),
+                        "", // Use default guessing for Steam games (we don't know the exe from .acf easily)
+                        me.app->appid
+                    );
+                }
+                seen.emplace(std::move(key), std::move(me));
             }
+        }
 
-            std::filesystem::path steamapps = *opt_path;
-            steamapps /= "steamapps";
+        // Anything not seen this time was uninstalled (or its library removed)
+        size_t dropped = 0;
+        for (const auto& [path, _] : manifestCache) {
+            if (!seen.count(path)) dropped++;
+        }
+        manifestCache = std::move(seen);
 
-            if (!std::filesystem::exists(steamapps)) continue;
+        Logger::instance().info("Steam manifests: " + std::to_string(parsed) + " parsed, " +
+            std::to_string(reused) + " unchanged, " + std::to_string(dropped) + " removed");
+        Logger::instance().info(std::string("Total Steam games found: ") + std::to_string(games.size()));
+        return games;
+    }
 
-            Logger::instance().info(std::string("Steam library found: ") + steamapps.string());
+    std::vector<WatchTarget> watchTargets() const override {
+        std::vector<WatchTarget> targets;
+        if (libraryFoldersFile.empty()) return targets;
+        targets.push_back({ libraryFoldersFile.parent_path(), "libraryfolders", ".vdf" });
+        for (const auto& lib : libraryFoldersCache) {
+            targets.push_back({ lib / "steamapps", "appmanifest_", ".acf" });
+        }
+        return targets;
+    }
 
-            for (const auto& entry : std::filesystem::directory_iterator(steamapps)) {
-                if (!entry.is_regular_file()) continue;
-                std::string filename = entry.path().filename().string();
-                if (filename.rfind("appmanifest_", 0) != 0 || entry.path().extension() != ".acf")
-                    continue;
+private:
+    struct Fingerprint {
+        int64_t mtime = 0;
+        uint64_t size = 0;
+        uint64_t inode = 0;
+        bool operator==(const Fingerprint&) const = default;
+    };
+    struct SteamApp {
+        std::string name;
+        int appid;
+    };
+    struct ManifestEntry {
+        Fingerprint fp;
+        std::optional<SteamApp> app; // nullopt for broken or filtered manifests
+    };
 
-                std::ifstream manifest(entry.path());
-                if (!manifest) continue;
+    std::unordered_map<std::string, ManifestEntry> manifestCache;
+    std::optional<Fingerprint> libraryFoldersFp;
+    std::vector<std::filesystem::path> libraryFoldersCache;
+    std::filesystem::path libraryFoldersFile;
+    std::filesystem::path libraryFoldersOverride;
 
-                tyti::vdf::object app;
-                try {
-                    app = tyti::vdf::read(manifest);
-                } catch (...) {
-                    Logger::instance().error(std::string("Failed to parse ") + filename);
-                    continue;
-                }
+    static std::optional<Fingerprint> fingerprint(const std::filesystem::path& p) {
+#ifdef _WIN32
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(p, ec);
+        if (ec) return std::nullopt;
+        auto size = std::filesystem::file_size(p, ec);
+        if (ec) return std::nullopt;
+        return Fingerprint{ (int64_t)mtime.time_since_epoch().count(), (uint64_t)size, 0 };
+#else
+        struct stat st;
+        if (::stat(p.c_str(), &st) != 0) return std::nullopt;
+        return Fingerprint{ (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec,
+                            (uint64_t)st.st_size, (uint64_t)st.st_ino };
+#endif
+    }
+
+    static std::filesystem::path libraryFoldersPath() {
+#ifdef _WIN32
+        return R"(C:\Program Files (x86)\Steam\steamapps\libraryfolders.vdf)";
+#else
+        const char* home_env = std::getenv("HOME");
+        std::filesystem::path home = home_env ? std::filesystem::path(home_env) : ".";
+        std::filesystem::path steam_path = home / ".local/share/Steam/steamapps/libraryfolders.vdf";
+        std::filesystem::path flathub_path = home / ".var/app/com.valvesoftware.Steam/data/Steam/steamapps/libraryfolders.vdf";
+
+        if (std::filesystem::exists(steam_path)) return steam_path;
+        Logger::instance().info("Could not open libraryfolders.vdf at " + steam_path.string() + ", trying flathub");
+        return flathub_path;
+#endif
+    }
+
+    // Library roots from libraryfolders.vdf, reparsed only when the file changes
+    std::optional<std::vector<std::filesystem::path> > libraryPaths() {
+        std::filesystem::path path = libraryFoldersOverride.empty() ? libraryFoldersPath() : libraryFoldersOverride;
+        auto fp = fingerprint(path);
+        if (!fp) {
+            Logger::instance().error("Could not open libraryfolders.vdf at " + path.string());
+            return std::nullopt;
+        }
+        if (libraryFoldersFp && *libraryFoldersFp == *fp) return libraryFoldersCache;
 
-                const tyti::vdf::object* state = nullptr;
-                if (app.name == "AppState") {
-                    state = &app;
+        MappedFile file(path);
+        if (!file.isOpen()) {
+            Logger::instance().error("Could not open libraryfolders.vdf");
+            return std::nullopt;
+        }
+
+        // "libraryfolders" { "<id>" { "path" "..." ... } ... }
+        // Older files keep the path one level deeper ("path" { "..." "..." }).
+        std::vector<std::filesystem::path> libraries;
+        VdfReader reader(file.view());
+        VdfReader::Event ev;
+        std::string_view libraryId;
+        bool havePath = false;
+        while (reader.next(ev)) {
+            int depth = reader.depth();
+            if (ev.type == VdfReader::Event::ObjectBegin) {
+                if (depth == 1) {
+                    Logger::instance().info(std::string("Root name: ") + std::string(ev.key));
+                } else if (depth == 2) {
+                    libraryId = ev.key;
+                    havePath = false;
+                } else if (depth == 3 && !havePath && ev.key == "path") {
+                    VdfReader::Event inner;
+                    if (reader.next(inner) && inner.type == VdfReader::Event::KeyValue) {
+                        libraries.emplace_back(VdfReader::unescape(inner.value));
+                        havePath = true;
+                    }
+                    if (reader.depth() == 3) reader.skipObject();
                 } else {
-                    auto st_it = app.childs.find("AppState");
-                    if (st_it != app.childs.end()) state = st_it->second.get();
+                    reader.skipObject();
                 }
-
-                if (!state) {
-                    Logger::instance().error(std::string("No AppState in appmanifest: ") + filename);
-                    continue;
+            } else if (ev.type == VdfReader::Event::KeyValue) {
+                if (depth == 2 && !havePath && ev.key == "path") {
+                    libraries.emplace_back(VdfReader::unescape(ev.value));
+                    havePath = true;
                 }
+            } else if (depth == 1 && !libraryId.empty()) {
+                if (!havePath) Logger::instance().error(std::string("No path for library id: ") + std::string(libraryId));
+                libraryId = {};
+            }
+        }
+        if (reader.failed()) {
+            Logger::instance().error("Failed to parse libraryfolders.vdf");
+            return std::nullopt;
+        }
 
-                // 5. Pobierz name, installdir i appid z atrybutów state (używamy bezpośrednio attribs)
-                auto name_it = state->attribs.find("name");
-                auto installdir_it = state->attribs.find("installdir");
-                auto appid_it = state->attribs.find("appid");
+        libraryFoldersFp = fp;
+        libraryFoldersCache = libraries;
+        libraryFoldersFile = path;
+        return libraries;
+    }
 
-                if (name_it == state->attribs.end() ||
-                    installdir_it == state->attribs.end() ||
-                    appid_it == state->attribs.end()) {
-                    Logger::instance().error(std::string("Missing attribute in appmanifest: ") + filename);
-                    continue;
-                }
+    static std::optional<SteamApp> parseManifest(const std::filesystem::path& path) {
+        std::string filename = path.filename().string();
+        MappedFile manifest(path);
+        if (!manifest.isOpen()) return std::nullopt;
 
-                std::string name = name_it->second;
-                std::string appid = appid_it->second;
+        // "AppState" { "appid" "..." "name" "..." "installdir" "..." ... }
+        VdfReader reader(manifest.view());
+        VdfReader::Event ev;
+        bool inState = false;
+        std::optional<std::string_view> name_v, installdir_v, appid_v;
+        while (reader.next(ev)) {
+            if (ev.type == VdfReader::Event::ObjectBegin) {
+                if (reader.depth() == 1 && ev.key == "AppState") inState = true;
+                else reader.skipObject(); // InstalledDepots, UserConfig, ...
+            } else if (ev.type == VdfReader::Event::KeyValue && inState && reader.depth() == 1) {
+                if (ev.key == "name") name_v = ev.value;
+                else if (ev.key == "installdir") installdir_v = ev.value;
+                else if (ev.key == "appid") appid_v = ev.value;
+            } else if (ev.type == VdfReader::Event::ObjectEnd && reader.depth() == 0 && inState) {
+                break;
+            }
+        }
+        if (reader.failed()) {
+            Logger::instance().error(std::string("Failed to parse ") + filename);
+            return std::nullopt;
+        }
 
-                // replace underscores with spaces
-                std::replace(name.begin(), name.end(), '_', ' ');
+        if (!inState) {
+            Logger::instance().error(std::string("No AppState in appmanifest: ") + filename);
+            return std::nullopt;
+        }
 
-                if(name == "Steamworks Common Redistributables"){
-                    continue;
-                }else if (name.find("Proton") != std::string::npos){
-                    continue;
-                }else if (name.find("Steam") != std::string::npos){
-                    continue;
-                }
+        if (!name_v || !installdir_v || !appid_v) {
+            Logger::instance().error(std::string("Missing attribute in appmanifest: ") + filename);
+            return std::nullopt;
+        }
 
-                games.emplace_back(
-                    name,
-                    Game::STEAM,
-                    std::filesystem::path("steam://run/" + appid),
-                    "", // Use default guessing for Steam games (we don't know the exe from .acf easily)
-                    std::stoi(appid)
-                );
-            }
+        std::string name = VdfReader::unescape(*name_v);
+
+        // replace underscores with spaces
+        std::replace(name.begin(), name.end(), '_', ' ');
+
+        if(name == "Steamworks Common Redistributables"){
+            return std::nullopt;
+        }else if (name.find("Proton") != std::string::npos){
+            return std::nullopt;
+        }else if (name.find("Steam") != std::string::npos){
+            return std::nullopt;
         }
 
-        Logger::instance().info(std::string("Total Steam games found: ") + std::to_string(games.size()));
-        return games;
+        int appid = 0;
+        try {
+            appid = std::stoi(std::string(*appid_v));
+        } catch (...) {
+            Logger::instance().error(std::string("Invalid appid in appmanifest: ") + filename);
+            return std::nullopt;
+        }
+        return SteamApp{ name, appid };
     }
 };
 
-} // namespace MultiLauncher
\ No newline at end of file
+} // namespace MultiLauncher
@@ -0,0 +1,197 @@
+#pragma once
+#include "Game.hpp"
+#include "Logger.hpp"
+#include "../external/JSON/json.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+
+namespace MultiLauncher {
+
+    // Keeps resident banner textures under a byte budget. Games report a
+    // loaded banner with add() and every draw with touch(); at the start of
+    // each frame the least recently drawn banners are released until the
+    // total fits. A released banner goes back to BannerNotLoaded and is
+    // decoded again from its file on disk when it is next shown. Banners
+    // drawn in the previous frame are never released, so the selected game
+    // keeps its banner even if it alone is over budget.
+    //
+    // The budget lives in texture_cache.json.
+    class TextureCache {
+    public:
+        static constexpr uint64_t DefaultBudget = 256ull << 20;
+        static constexpr uint64_t MinBudget = 16ull << 20;
+
+        struct Entry {
+            std::string game;
+            uint64_t bytes = 0;
+            uint64_t lastUsedFrame = 0;
+        };
+
+        struct Stats {
+            uint64_t usedBytes = 0;
+            uint64_t budgetBytes = 0;
+            size_t textures = 0;
+            uint64_t evictions = 0;
+            uint64_t frame = 0;
+        };
+
+        static TextureCache& instance() {
+            static TextureCache inst;
+            return inst;
+        }
+
+        uint64_t budget() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return budget_;
+        }
+
+        // Takes effect at the next frame
+        void setBudget(uint64_t bytes) {
+            std::lock_guard<std::mutex> lk(m_);
+            budget_ = std::max(bytes, MinBudget);
+            save();
+        }
+
+        // Render thread: `game` now holds a texture of `bytes`
+        void add(Game& game, uint64_t bytes) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto& e = entries_[&game];
+            used_ -= e.bytes;
+            e.game = game.weak_from_this();
+            e.name = game.getName();
+            e.bytes = bytes;
+            e.lastUsedFrame = frame_;
+            used_ += bytes;
+        }
+
+        // Render thread, whenever the game's banner is drawn
+        void touch(const Game& game) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = entries_.find(&game);
+            if (it != entries_.end()) it->second.lastUsedFrame = frame_;
+        }
+
+        // The game's texture is gone (released or destroyed)
+        void remove(const Game& game) {
+            std::lock_guard<std::mutex> lk(m_);
+            auto it = entries_.find(&game);
+            if (it == entries_.end()) return;
+            used_ -= it->second.bytes;
+            entries_.erase(it);
+        }
+
+        // Render thread, at the start of each frame
+        void beginFrame() {
+            uint64_t frame;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                frame = ++frame_;
+            }
+            while (auto victim = nextVictim(frame)) {
+                victim->releaseBanner();
+            }
+        }
+
+        // Render thread, before the graphics context goes away
+        void releaseAll() {
+            std::vector<std::shared_ptr<Game> > games;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                for (auto& [key, e] : entries_) {
+                    if (auto game = e.game.lock()) games.push_back(std::move(game));
+                }
+            }
+            for (auto& game : games) game->releaseBanner();
+        }
+
+        Stats stats() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return { used_, budget_, entries_.size(), evictions_, frame_ };
+        }
+
+        // Most recently used first
+        std::vector<Entry> entries() const {
+            std::vector<Entry> out;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                out.reserve(entries_.size());
+                for (const auto& [key, e] : entries_) out.push_back({ e.name, e.bytes, e.lastUsedFrame });
+            }
+            std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) { return a.lastUsedFrame > b.lastUsedFrame; });
+            return out;
+        }
+
+    private:
+        TextureCache() { load(); }
+
+        struct Resident {
+            std::weak_ptr<Game> game;
+            std::string name;
+            uint64_t bytes = 0;
+            uint64_t lastUsedFrame = 0;
+        };
+
+        mutable std::mutex m_;
+        std::unordered_map<const Game*, Resident> entries_;
+        uint64_t used_ = 0;
+        uint64_t budget_ = DefaultBudget;
+        uint64_t frame_ = 0;
+        uint64_t evictions_ = 0;
+
+        // The least recently used banner not drawn since the last frame, if
+        // over budget; it is dropped from the accounting here, so releasing
+        // it does not find it again. A banner whose larger variant is still
+        // decoding is skipped: releaseBanner() leaves it alone, and its
+        // texture would stay on the GPU uncounted.
+        std::shared_ptr<Game> nextVictim(uint64_t frame) {
+            std::lock_guard<std::mutex> lk(m_);
+            while (used_ > budget_) {
+                auto victim = entries_.end();
+                for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                    if (it->second.lastUsedFrame + 1 >= frame) continue;
+                    auto game = it->second.game.lock();
+                    if (game && game->bannerStatus.load() != Game::BannerLoaded) continue;
+                    if (victim == entries_.end() || it->second.lastUsedFrame < victim->second.lastUsedFrame) victim = it;
+                }
+                if (victim == entries_.end()) return nullptr;
+                auto game = victim->second.game.lock();
+                used_ -= victim->second.bytes;
+                entries_.erase(victim);
+                // a game that is already gone freed its texture itself
+                if (game) {
+                    evictions_++;
+                    return game;
+                }
+            }
+            return nullptr;
+        }
+
+        void load() {
+            if (!std::filesystem::exists("texture_cache.json")) return;
+            try {
+                std::ifstream i("texture_cache.json");
+                nlohmann::json j;
+                i >> j;
+                budget_ = std::max(j.value("budgetBytes", DefaultBudget), MinBudget);
+            } catch (...) {}
+        }
+
+        // m_ must be held
+        void save() const {
+            try {
+                nlohmann::json j;
+                j["budgetBytes"] = budget_;
+                std::ofstream o("texture_cache.json");
+                o << j.dump(2);
+            } catch (...) {}
+        }
+    };
+
+}
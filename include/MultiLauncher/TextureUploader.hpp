@@ -0,0 +1,240 @@
+#pragma once
+#include "Game.hpp"
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+#include <utility>
+#include <algorithm>
+#ifdef _WIN32
+#include <d3d11.h>
+#endif
+
+namespace MultiLauncher {
+
+    // Recycles the large buffers image decoding needs. stb_image allocates
+    // through it (STBI_MALLOC and friends, where the implementation is
+    // compiled), so a banner decodes into a buffer a previous banner left
+    // behind instead of fresh pages. Sizes are rounded up to a quarter of
+    // their power of two, so a recycled buffer wastes at most a fifth.
+    class PixelPool {
+    public:
+        // Smaller allocations go straight to malloc
+        static constexpr size_t MinPooled = 256 * 1024;
+        // Free buffers kept for reuse, in bytes
+        static constexpr size_t MaxRetained = 96ull << 20;
+
+        static PixelPool& instance() {
+            static PixelPool inst;
+            return inst;
+        }
+
+        void* allocate(size_t size) {
+            size_t cls = sizeClass(size);
+            void* block = nullptr;
+            if (cls >= MinPooled) {
+                std::lock_guard<std::mutex> lk(m_);
+                auto it = free_.find(cls);
+                if (it != free_.end() && !it->second.empty()) {
+                    block = it->second.back();
+                    it->second.pop_back();
+                    retained_ -= cls;
+                    reused_++;
+                }
+            }
+            if (!block) block = std::malloc(Header + cls);
+            if (!block) return nullptr;
+            *static_cast<size_t*>(block) = cls;
+            return static_cast<char*>(block) + Header;
+        }
+
+        void release(void* p) {
+            if (!p) return;
+            void* block = static_cast<char*>(p) - Header;
+            size_t cls = *static_cast<size_t*>(block);
+            if (cls >= MinPooled) {
+                std::lock_guard<std::mutex> lk(m_);
+                if (retained_ + cls <= MaxRetained) {
+                    free_[cls].push_back(block);
+                    retained_ += cls;
+                    return;
+                }
+            }
+            std::free(block);
+        }
+
+        void* reallocate(void* p, size_t size) {
+            if (!p) return allocate(size);
+            size_t cls = *reinterpret_cast<size_t*>(static_cast<char*>(p) - Header);
+            if (size <= cls) return p;
+            void* grown = allocate(size);
+            if (!grown) return nullptr;
+            std::memcpy(grown, p, cls);
+            release(p);
+            return grown;
+        }
+
+        // Allocations served from a recycled buffer
+        uint64_t reused() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return reused_;
+        }
+
+    private:
+        // keeps the payload 16-byte aligned
+        static constexpr size_t Header = 16;
+
+        mutable std::mutex m_;
+        std::map<size_t, std::vector<void*> > free_; // by size class
+        size_t retained_ = 0;
+        uint64_t reused_ = 0;
+
+        static size_t sizeClass(size_t size) {
+            if (size < MinPooled) return size;
+            size_t step = std::bit_floor(size) / 4;
+            return (size + step - 1) / step * step;
+        }
+    };
+
+    // An RGBA image and, optionally, its mip chain down to 1x1, back to back
+    // in one PixelPool buffer, largest level first.
+    class MipImage {
+    public:
+        struct Level {
+            int width = 0;
+            int height = 0;
+            size_t offset = 0;
+        };
+
+        MipImage() = default;
+        MipImage(const MipImage&) = delete;
+        MipImage& operator=(const MipImage&) = delete;
+        MipImage(MipImage&& other) noexcept { *this = std::move(other); }
+        MipImage& operator=(MipImage&& other) noexcept {
+            if (this != &other) {
+                PixelPool::instance().release(data_);
+                data_ = std::exchange(other.data_, nullptr);
+                bytes_ = std::exchange(other.bytes_, 0);
+                levels_ = std::move(other.levels_);
+                downscaled = other.downscaled;
+            }
+            return *this;
+        }
+        ~MipImage() { PixelPool::instance().release(data_); }
+
+        // Room for a `width` x `height` image and, with `mips`, its chain;
+        // empty if the allocation failed
+        static MipImage allocate(int width, int height, bool mips) {
+            MipImage image;
+            size_t bytes = 0;
+            while (true) {
+                image.levels_.push_back({ width, height, bytes });
+                bytes += (size_t)width * height * 4;
+                if (!mips || (width == 1 && height == 1)) break;
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+            image.data_ = static_cast<unsigned char*>(PixelPool::instance().allocate(bytes));
+            if (!image.data_) return MipImage{};
+            image.bytes_ = bytes;
+            return image;
+        }
+
+        explicit operator bool() const { return data_ != nullptr; }
+        int width() const { return levels_.empty() ? 0 : levels_[0].width; }
+        int height() const { return levels_.empty() ? 0 : levels_[0].height; }
+        size_t bytes() const { return bytes_; }
+        const std::vector<Level>& levels() const { return levels_; }
+        unsigned char* level(size_t i) { return data_ + levels_[i].offset; }
+        const unsigned char* level(size_t i) const { return data_ + levels_[i].offset; }
+
+        // A display-sized variant of a larger original
+        bool downscaled = false;
+
+    private:
+        unsigned char* data_ = nullptr;
+        size_t bytes_ = 0;
+        std::vector<Level> levels_;
+    };
+
+    // Turns banner files into textures without stalling the frame. Files are
+    // decoded to RGBA on the executor's Interactive lane; the render thread
+    // only uploads, in strips of rows a level at a time, and stops for the
+    // frame once it has spent FrameBytes or FrameTime. On GL 3 the strips are
+    // copied into a mapped pixel buffer object, so glTexSubImage2D queues the
+    // transfer from it instead of copying the rows itself. A texture is
+    // handed out only when all of it is uploaded.
+    class TextureUploader {
+    public:
+        static constexpr size_t FrameBytes = 8ull << 20;
+        static constexpr std::chrono::microseconds FrameTime{2000};
+        // Most bytes per strip, so FrameTime is checked between strips
+        static constexpr size_t StripBytes = 1ull << 20;
+
+        static TextureUploader& instance() {
+            static TextureUploader inst;
+            return inst;
+        }
+
+        // Render thread, once the graphics context exists
+#ifdef _WIN32
+        void init(ID3D11Device* device, ID3D11DeviceContext* context);
+#else
+        void init(const std::function<void*(const char*)>& getProcAddress);
+#endif
+
+        // Any thread. `decode` runs on the Interactive lane and returns the
+        // image with all the levels the texture gets (empty on failure;
+        // `name` labels the log line). `done` runs on the render thread,
+        // from uploadFrame(), with the finished texture, or an empty one if
+        // decoding failed; it owns the texture from then on.
+        void load(const std::string& name, std::function<MipImage()> decode, std::function<void(BannerTexture)> done);
+
+        // Render thread, once per frame before anything draws
+        void uploadFrame();
+
+        // Render thread, before the graphics context goes away: frees
+        // unfinished textures and drops callbacks that did not run
+        void shutdown();
+
+    private:
+        TextureUploader() = default;
+
+        struct Job {
+            std::string name;
+            std::function<void(BannerTexture)> done;
+            MipImage image;
+            size_t level = 0;
+            int rowsUploaded = 0; // of the current level
+            BannerTexture texture;
+            std::chrono::steady_clock::time_point queuedAt;
+            double decodeMs = 0;
+            int frames = 0;
+        };
+
+        std::mutex m_;
+        std::deque<Job> decoded_; // waiting for upload, in decode order
+        bool ready_ = false;
+        bool stopping_ = false;
+        // render thread only
+        bool usePbo_ = false;
+        unsigned int pbo_ = 0;
+#ifdef _WIN32
+        ID3D11Device* device_ = nullptr;
+        ID3D11DeviceContext* context_ = nullptr;
+#endif
+
+        bool createTexture(Job& job);
+        // Uploads `rows` rows of job.level from job.rowsUploaded on
+        void uploadRows(Job& job, int rows);
+        static void freeTexture(BannerTexture& texture);
+    };
+
+}
@@ -0,0 +1,333 @@
+#pragma once
+#include "ProcessRunner.hpp"
+#include "Logger.hpp"
+#include "../external/JSON/json.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <ctime>
+#include <cstdint>
+
+namespace MultiLauncher {
+
+    // Classic token bucket: `rate` bytes per second on average, bursts up to
+    // `burst` bytes. A rate of 0 lets everything through.
+    class TokenBucket {
+    public:
+        void setRate(double bytesPerSec, double burst) {
+            std::lock_guard<std::mutex> lk(m_);
+            refill();
+            rate_ = bytesPerSec;
+            burst_ = burst;
+            tokens_ = std::min(tokens_, burst_);
+        }
+
+        // Blocks the caller until `bytes` may pass. Callers that overdraw
+        // leave the bucket negative, so concurrent callers queue behind them.
+        void acquire(size_t bytes) {
+            std::chrono::duration<double> wait{0};
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (rate_ <= 0) return;
+                refill();
+                tokens_ -= (double)bytes;
+                if (tokens_ < 0) wait = std::chrono::duration<double>(-tokens_ / rate_);
+            }
+            if (wait.count() > 0) std::this_thread::sleep_for(wait);
+        }
+
+    private:
+        std::mutex m_;
+        double rate_ = 0;
+        double burst_ = 0;
+        double tokens_ = 0;
+        std::chrono::steady_clock::time_point last_ = std::chrono::steady_clock::now();
+
+        void refill() {
+            auto now = std::chrono::steady_clock::now();
+            tokens_ = std::min(burst_, tokens_ + rate_ * std::chrono::duration<double>(now - last_).count());
+            last_ = now;
+        }
+    };
+
+    // When and how much the launcher's own transfers may use
+    struct TransferPolicy {
+        // Local time windows [fromHour, toHour), wrapping past midnight when
+        // fromHour > toHour, e.g. { 9, 18, 2 MiB/s } for office hours
+        struct Window {
+            int fromHour = 0;
+            int toHour = 0;
+            uint64_t capBytesPerSec = 0;
+        };
+        uint64_t capBytesPerSec = 0;            // always; 0 means no cap
+        uint64_t playingCapBytesPerSec = 1 << 20; // while any game is running; 0 means no cap
+        std::vector<Window> windows;
+    };
+
+    // Shapes Epic installs and banner downloads to the budget the policy
+    // gives for now: the lowest of the global cap, the cap of the current
+    // time window and, while a game is running, the playing cap. Running
+    // also puts installs at idle I/O (Linux) or CPU (Windows) priority.
+    //
+    // legendary has no rate limit option, so installs are shaped from the
+    // outside. On Windows the install's job object gets a network rate cap.
+    // On Linux the install's process group is duty-cycled with SIGSTOP and
+    // SIGCONT: each second it runs for the fraction that brings the rate
+    // legendary reports down to its share. Under a cap, installs also start
+    // with fewer download workers. Banner downloads draw from a token bucket
+    // at the same budget.
+    //
+    // The policy lives in transfer_policy.json.
+    class TransferScheduler {
+    public:
+        static constexpr std::chrono::milliseconds Tick{100};
+        static constexpr std::chrono::milliseconds Period{1000};
+        // Lowest share of each period a throttled install still runs
+        static constexpr double MinRunFraction = 0.05;
+
+        static TransferScheduler& instance() {
+            static TransferScheduler inst;
+            return inst;
+        }
+
+        TransferPolicy policy() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return policy_;
+        }
+
+        void setPolicy(const TransferPolicy& policy) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                policy_ = policy;
+                save();
+                applyBudgetLocked();
+            }
+            cv_.notify_all();
+        }
+
+        // GameManager reports whether any game is running after every check
+        void setPlaying(bool playing) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (playing_ == playing) return;
+                playing_ = playing;
+                Logger::instance().info(playing ? "A game is running, background transfers limited"
+                                                : "No game running, background transfers back to normal");
+                applyBudgetLocked();
+            }
+            cv_.notify_all();
+        }
+
+        // Bytes per second all transfers may use right now; 0 means no cap
+        uint64_t budget() const {
+            std::lock_guard<std::mutex> lk(m_);
+            return budgetLocked();
+        }
+
+        // Most `legendary install` workers for the current budget, 0 for no
+        // limit. Each worker fetches one chunk at a time; a few are enough for
+        // a capped link and make the duty cycle smoother.
+        int maxWorkers() const {
+            uint64_t cap = budget();
+            if (!cap) return 0;
+            return (int)std::clamp<uint64_t>(cap / (2 << 20), 1, 4);
+        }
+
+        // Shapes a running install until its process finishes. `rate` returns
+        // the download rate legendary reports, in bytes per second.
+        void track(std::shared_ptr<ProcessHandle> handle, std::function<float()> rate) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                Install install;
+                install.handle = std::move(handle);
+                install.rate = std::move(rate);
+                installs_.push_back(std::move(install));
+                if (!thread_.joinable()) thread_ = std::thread([this]() { loop(); });
+            }
+            cv_.notify_all();
+        }
+
+        // For our own downloads: blocks until `bytes` fit the budget
+        void acquireDownload(size_t bytes) {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                refreshHourLocked();
+            }
+            downloads_.acquire(bytes);
+        }
+
+    private:
+        TransferScheduler() {
+            load();
+            refreshHourLocked();
+        }
+        ~TransferScheduler() {
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            if (thread_.joinable()) thread_.join();
+        }
+
+        struct Install {
+            std::shared_ptr<ProcessHandle> handle;
+            std::function<float()> rate;
+            double runFraction = 1.0;
+            bool suspended = false;
+            bool background = false;
+            uint64_t netCap = 0;
+            std::chrono::steady_clock::time_point periodStart;
+        };
+
+        mutable std::mutex m_;
+        std::condition_variable cv_;
+        TransferPolicy policy_;
+        bool playing_ = false;
+        bool stopping_ = false;
+        int hour_ = -1;
+        std::vector<Install> installs_;
+        std::thread thread_;
+        TokenBucket downloads_;
+
+        static int localHour() {
+            std::time_t now = std::time(nullptr);
+            std::tm local = {};
+#ifdef _WIN32
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            return local.tm_hour;
+        }
+
+        uint64_t budgetLocked() const {
+            uint64_t cap = 0;
+            auto lower = [&cap](uint64_t c) {
+                if (c && (!cap || c < cap)) cap = c;
+            };
+            lower(policy_.capBytesPerSec);
+            if (playing_) lower(policy_.playingCapBytesPerSec);
+            int hour = hour_ < 0 ? localHour() : hour_;
+            for (const auto& w : policy_.windows) {
+                bool inside = w.fromHour <= w.toHour ? (hour >= w.fromHour && hour < w.toHour)
+                                                     : (hour >= w.fromHour || hour < w.toHour);
+                if (inside) lower(w.capBytesPerSec);
+            }
+            return cap;
+        }
+
+        // Time windows start and end on the hour
+        void refreshHourLocked() {
+            int hour = localHour();
+            if (hour == hour_) return;
+            hour_ = hour;
+            applyBudgetLocked();
+        }
+
+        // Banners burst up to a quarter second of budget, at least 64 KiB
+        void applyBudgetLocked() {
+            double cap = (double)budgetLocked();
+            downloads_.setRate(cap, std::max(cap / 4, 64.0 * 1024));
+        }
+
+        void loop() {
+            std::unique_lock<std::mutex> lk(m_);
+            while (!stopping_) {
+                if (installs_.empty()) {
+                    cv_.wait(lk, [this]() { return stopping_ || !installs_.empty(); });
+                    continue;
+                }
+                refreshHourLocked();
+                uint64_t cap = budgetLocked();
+                bool background = playing_;
+                auto now = std::chrono::steady_clock::now();
+
+                std::erase_if(installs_, [](const Install& i) {
+                    return i.handle->finished() || i.handle->cancelled();
+                });
+                double share = cap ? (double)cap / std::max<size_t>(installs_.size(), 1) : 0;
+                for (auto& install : installs_) {
+                    ProcessHandle& handle = *install.handle;
+                    if (install.background != background && handle.setBackground(background)) {
+                        install.background = background;
+                    }
+                    uint64_t netCap = (uint64_t)share;
+                    if (install.netCap != netCap && handle.limitBandwidth(netCap)) {
+                        install.netCap = netCap;
+                        continue; // the OS shapes it, no duty cycle needed
+                    }
+                    if (install.netCap) continue;
+
+                    if (now - install.periodStart >= Period) {
+                        // a new period: adjust the run fraction to the rate seen
+                        install.periodStart = now;
+                        float rate = install.rate();
+                        if (!share) {
+                            install.runFraction = 1.0;
+                        } else if (rate > 0) {
+                            // at most halve or double per period, so a noisy rate does not oscillate
+                            double factor = std::clamp(share / rate, 0.5, 2.0);
+                            install.runFraction = std::clamp(install.runFraction * factor, MinRunFraction, 1.0);
+                        }
+                    }
+                    bool run = now - install.periodStart < Period * install.runFraction;
+                    if (run && install.suspended) {
+                        handle.signal(ProcessHandle::Continue);
+                        install.suspended = false;
+                    } else if (!run && !install.suspended && handle.signal(ProcessHandle::Suspend)) {
+                        install.suspended = true;
+                    }
+                }
+                cv_.wait_for(lk, Tick, [this]() { return stopping_; });
+            }
+            // never leave a process stopped behind
+            for (auto& install : installs_) {
+                if (install.suspended) install.handle->signal(ProcessHandle::Continue);
+            }
+        }
+
+        void load() {
+            if (!std::filesystem::exists("transfer_policy.json")) return;
+            try {
+                std::ifstream i("transfer_policy.json");
+                nlohmann::json j;
+                i >> j;
+                policy_.capBytesPerSec = j.value("capBytesPerSec", (uint64_t)0);
+                policy_.playingCapBytesPerSec = j.value("playingCapBytesPerSec", policy_.playingCapBytesPerSec);
+                for (const auto& w : j.value("windows", nlohmann::json::array())) {
+                    TransferPolicy::Window window;
+                    window.fromHour = w.value("fromHour", 0);
+                    window.toHour = w.value("toHour", 0);
+                    window.capBytesPerSec = w.value("capBytesPerSec", (uint64_t)0);
+                    policy_.windows.push_back(window);
+                }
+            } catch (...) {}
+        }
+
+        // m_ must be held
+        void save() const {
+            try {
+                nlohmann::json j;
+                j["capBytesPerSec"] = policy_.capBytesPerSec;
+                j["playingCapBytesPerSec"] = policy_.playingCapBytesPerSec;
+                j["windows"] = nlohmann::json::array();
+                for (const auto& w : policy_.windows) {
+                    j["windows"].push_back({ { "fromHour", w.fromHour }, { "toHour", w.toHour },
+                                             { "capBytesPerSec", w.capBytesPerSec } });
+                }
+                std::ofstream o("transfer_policy.json");
+                o << j.dump(2);
+            } catch (...) {}
+        }
+    };
+
+}
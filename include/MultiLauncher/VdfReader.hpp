@@ -0,0 +1,211 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MULTILAUNCHER_VDF_SSE2 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace MultiLauncher {
+
+    // Streaming tokenizer for Valve's KeyValues text format (appmanifest_*.acf,
+    // libraryfolders.vdf, localconfig.vdf). It walks a caller owned buffer
+    // (usually a MappedFile) and yields string_views into it, no tree and no
+    // per-token allocation. Escapes are left in place; use unescape() on the
+    // few values that need it.
+    //
+    //     VdfReader r(file.view());
+    //     VdfReader::Event ev;
+    //     while (r.next(ev)) { ... }
+    class VdfReader {
+    public:
+        struct Event {
+            enum Type { ObjectBegin, ObjectEnd, KeyValue };
+            Type type = KeyValue;
+            std::string_view key;   // empty for ObjectEnd
+            std::string_view value; // only for KeyValue
+        };
+
+        explicit VdfReader(std::string_view data) : p_(data.data()), end_(data.data() + data.size()) {}
+
+        // Returns false at end of input or on a syntax error (see failed())
+        bool next(Event& ev) {
+            std::string_view key;
+            if (!token(key)) return false;
+            if (isBrace(key, '}')) {
+                if (depth_ == 0) return fail();
+                depth_--;
+                ev.type = Event::ObjectEnd;
+                ev.key = {};
+                ev.value = {};
+                return true;
+            }
+            if (isBrace(key, '{')) return fail();
+
+            std::string_view value;
+            if (!token(value)) return fail();
+            if (isBrace(value, '{')) {
+                depth_++;
+                ev.type = Event::ObjectBegin;
+                ev.key = key;
+                ev.value = {};
+                return true;
+            }
+            if (isBrace(value, '}')) return fail();
+            ev.type = Event::KeyValue;
+            ev.key = key;
+            ev.value = value;
+            return true;
+        }
+
+        // Skips the rest of the object whose ObjectBegin was just returned
+        void skipObject() {
+            int target = depth_ - 1;
+            Event ev;
+            while (depth_ > target && next(ev)) {}
+        }
+
+        int depth() const { return depth_; }
+        bool failed() const { return failed_; }
+
+        static std::string unescape(std::string_view s) {
+            std::string out;
+            if (s.find('\\') == std::string_view::npos) return std::string(s);
+            out.reserve(s.size());
+            for (size_t i = 0; i < s.size(); ++i) {
+                if (s[i] == '\\' && i + 1 < s.size()) {
+                    char c = s[++i];
+                    switch (c) {
+                        case 'n': out += '\n'; break;
+                        case 't': out += '\t'; break;
+                        default: out += c; break; // \\ and \"
+                    }
+                } else {
+                    out += s[i];
+                }
+            }
+            return out;
+        }
+
+        static bool equalsNoCase(std::string_view a, std::string_view b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                char x = a[i], y = b[i];
+                if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+                if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+                if (x != y) return false;
+            }
+            return true;
+        }
+
+    private:
+        const char* p_;
+        const char* end_;
+        int depth_ = 0;
+        bool failed_ = false;
+        bool braceToken_ = false;
+
+        bool fail() {
+            failed_ = true;
+            p_ = end_;
+            return false;
+        }
+
+        bool isBrace(std::string_view t, char c) const {
+            return braceToken_ && t.size() == 1 && t[0] == c;
+        }
+
+        // Skips whitespace, // comments, #include/#base directives and [$PLATFORM] conditionals
+        void skipTrivia() {
+            while (p_ < end_) {
+                char c = *p_;
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                    p_++;
+                } else if (c == '/' && p_ + 1 < end_ && p_[1] == '/') {
+                    skipLine();
+                } else if (c == '#') {
+                    skipLine();
+                } else if (c == '[') {
+                    const void* close = std::memchr(p_, ']', end_ - p_);
+                    p_ = close ? (const char*)close + 1 : end_;
+                } else {
+                    return;
+                }
+            }
+        }
+
+        void skipLine() {
+            const void* nl = std::memchr(p_, '\n', end_ - p_);
+            p_ = nl ? (const char*)nl + 1 : end_;
+        }
+
+        bool token(std::string_view& out) {
+            skipTrivia();
+            if (p_ >= end_) return false;
+            braceToken_ = false;
+            char c = *p_;
+            if (c == '{' || c == '}') {
+                braceToken_ = true;
+                out = std::string_view(p_, 1);
+                p_++;
+                return true;
+            }
+            if (c == '"') {
+                const char* start = ++p_;
+                while (true) {
+                    const char* hit = findQuoteOrEscape(p_, end_);
+                    if (hit >= end_) return fail();
+                    if (*hit == '\\') {
+                        p_ = hit + 2; // skip the escaped character
+                        if (p_ > end_) return fail();
+                        continue;
+                    }
+                    out = std::string_view(start, hit - start);
+                    p_ = hit + 1;
+                    return true;
+                }
+            }
+            // Unquoted token: runs until whitespace, a quote or a brace
+            const char* start = p_;
+            while (p_ < end_) {
+                c = *p_;
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '"' || c == '{' || c == '}') break;
+                p_++;
+            }
+            out = std::string_view(start, p_ - start);
+            return true;
+        }
+
+        // First '"' or '\\' in [p, end), or end. This is the hot loop for big
+        // files, so it looks at 16 bytes per step when SSE2 is available.
+        static const char* findQuoteOrEscape(const char* p, const char* end) {
+#ifdef MULTILAUNCHER_VDF_SSE2
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i slash = _mm_set1_epi8('\\');
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+                int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                          _mm_cmpeq_epi8(chunk, slash)));
+                if (mask) {
+#if defined(_MSC_VER)
+                    unsigned long bit;
+                    _BitScanForward(&bit, (unsigned long)mask);
+                    return p + bit;
+#else
+                    return p + __builtin_ctz((unsigned)mask);
+#endif
+                }
+                p += 16;
+            }
+#endif
+            while (p < end && *p != '"' && *p != '\\') p++;
+            return p;
+        }
+    };
+
+}
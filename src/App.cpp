@@ -4,6 +4,11 @@
 #include "../include/MultiLauncher/SteamScanner.hpp"
 #include "../include/MultiLauncher/GogScanner.hpp"
 #include "../include/MultiLauncher/PlaytimeManager.hpp"
+#include "../include/MultiLauncher/SessionTracker.hpp"
+#include "../include/MultiLauncher/FrameStats.hpp"
+#include "../include/MultiLauncher/Executor.hpp"
+#include "../include/MultiLauncher/DownloadQueue.hpp"
+#include "../include/MultiLauncher/BannerFetcher.hpp"
 #ifdef _WIN32
 #include <windows.h>
 #include <d3d11.h>
@@ -117,22 +122,32 @@ namespace MultiLauncher{
         gui.init(hwnd, g_pd3dDevice, g_pd3dDeviceContext, g_mainRenderTargetView);
 
         // Init playtime tracking
-        PlaytimeManager::instance().init();
+        PlaytimeManager::instance().initAsync();
 
         MultiLauncher::GameManager manager;
         manager.addScanner(std::make_unique<SteamScanner>());
         manager.addScanner(std::make_unique<EpicScanner>());
         manager.addScanner(std::make_unique<GogScanner>());
+
+        // Installs queued in the last session continue once their game is known
+        manager.onLibraryChanged([](){ DownloadQueue::instance().pump(); });
+
+        // Show the last known library immediately, scanners reconcile it below
+        manager.loadIndex();
+        DownloadQueue::instance().attach([&manager](const std::string& name){
+            return manager.findGame(GameCatalog::makeId(Game::EPIC, GameCatalog::normalizeName(name)));
+        });
+        manager.watchLibraries();
+        manager.trackProcesses();
+        SessionTracker::instance().enable();
         
         // Scan in background to avoid UI lag
-        std::thread([&manager](){
-            manager.scanAll();
-        }).detach();
+        manager.scanAsync();
 
         // Main loop
         MSG msg;
         ZeroMemory(&msg, sizeof(msg));
-        auto lastUpdate = std::chrono::steady_clock::now();
+        FrameStats frameStats(std::chrono::seconds(60));
 
         while (msg.message != WM_QUIT) {
             if (PeekMessage(&msg, nullptr, 0,0, PM_REMOVE)) {
@@ -141,12 +156,6 @@ namespace MultiLauncher{
                 continue;
             }
 
-            auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(now - lastUpdate).count() >= 2) {
-                manager.update();
-                lastUpdate = now;
-            }
-
             g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
             ImGui_ImplDX11_NewFrame();
             ImGui_ImplWin32_NewFrame();
@@ -159,8 +168,15 @@ namespace MultiLauncher{
             g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color);
             ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
             g_pSwapChain->Present(1,0);
+
+            if (frameStats.tick()) Logger::instance().info("Frame times: " + frameStats.last().toString());
         }
 
+        // Let legendary save its resume state, then drop queued work and give
+        // running tasks a moment before teardown
+        DownloadQueue::instance().shutdown();
+        EpicProvider::stopInstalls(std::chrono::seconds(2));
+        Executor::instance().shutdown(std::chrono::seconds(2));
         gui.shutdown();
         CleanupDeviceD3D();
         UnregisterClassA(wc.lpszClassName, wc.hInstance);
@@ -191,30 +207,34 @@ namespace MultiLauncher{
         gui.init(window); 
 
         // Init playtime tracking
-        PlaytimeManager::instance().init();
+        PlaytimeManager::instance().initAsync();
 
         MultiLauncher::GameManager manager;
         manager.addScanner(std::make_unique<SteamScanner>());
         manager.addScanner(std::make_unique<EpicScanner>());
         manager.addScanner(std::make_unique<GogScanner>());
+
+        // Installs queued in the last session continue once their game is known
+        manager.onLibraryChanged([](){ DownloadQueue::instance().pump(); });
+
+        // Show the last known library immediately, scanners reconcile it below
+        manager.loadIndex();
+        DownloadQueue::instance().attach([&manager](const std::string& name){
+            return manager.findGame(GameCatalog::makeId(Game::EPIC, GameCatalog::normalizeName(name)));
+        });
+        manager.watchLibraries();
+        manager.trackProcesses();
+        SessionTracker::instance().enable();
         
         // Scan in background
-        std::thread([&manager](){
-            manager.scanAll();
-        }).detach();
+        manager.scanAsync();
 
         // Main loop
-        auto lastUpdate = std::chrono::steady_clock::now();
+        FrameStats frameStats(std::chrono::seconds(60));
         while (!glfwWindowShouldClose(window))
         {
             glfwPollEvents();
 
-             auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(now - lastUpdate).count() >= 2) {
-                manager.update();
-                lastUpdate = now;
-            }
-
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
             ImGui::NewFrame();
@@ -230,8 +250,16 @@ namespace MultiLauncher{
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
             glfwSwapBuffers(window);
+
+            if (frameStats.tick()) Logger::instance().info("Frame times: " + frameStats.last().toString());
         }
 
+        // Let legendary save its resume state, then drop queued work and give
+        // running tasks a moment before teardown
+        DownloadQueue::instance().shutdown();
+        EpicProvider::stopInstalls(std::chrono::seconds(2));
+        BannerFetcher::instance().shutdown();
+        Executor::instance().shutdown(std::chrono::seconds(2));
         gui.shutdown();
         glfwDestroyWindow(window);
         glfwTerminate();
@@ -1,5 +1,6 @@
 #include "../include/MultiLauncher/Game.hpp"
-#include "../include/external/stb_image.h"
+#include "../include/MultiLauncher/TextureUploader.hpp"
+#include "../include/MultiLauncher/TextureCache.hpp"
 #ifdef __linux__
 #include <GL/gl.h>
 #endif
@@ -9,6 +10,11 @@
 #include <cctype>
 #include <chrono>
 #include "../include/MultiLauncher/PlaytimeManager.hpp"
+#include "../include/MultiLauncher/LaunchMetrics.hpp"
+#include "../include/MultiLauncher/Executor.hpp"
+#include "../include/MultiLauncher/TransferScheduler.hpp"
+#include "../include/MultiLauncher/BannerFetcher.hpp"
+#include "../include/MultiLauncher/BannerVariants.hpp"
 
 #ifdef _WIN32
 #include <shellapi.h>
@@ -76,6 +82,7 @@ bool DownloadFile(const std::wstring& url, const std::wstring& filePath) {
     char buffer[4096];
     DWORD bytesRead = 0;
     while (WinHttpReadData(hRequest, buffer, sizeof(buffer), &bytesRead) && bytesRead > 0) {
+        MultiLauncher::TransferScheduler::instance().acquireDownload(bytesRead);
         DWORD bytesWritten = 0;
         WriteFile(hFile, buffer, bytesRead, &bytesWritten, NULL);
     }
@@ -90,7 +97,6 @@ bool DownloadFile(const std::wstring& url, const std::wstring& filePath) {
 #else
 #include <unistd.h>
 #include <sys/wait.h>
-#include <curl/curl.h>
 #include <cstdio>
 #include <dirent.h>
 #include <cstring>
@@ -111,49 +117,50 @@ namespace MultiLauncher {
 
     Game::~Game() {
         if(banner.srv) {
+            TextureCache::instance().remove(*this);
+            freeBanner();
+        }
+    }
+
+    void Game::freeBanner() {
+        if(!banner.srv) return;
 #ifdef _WIN32
-            banner.srv->Release();
+        banner.srv->Release();
 #else
-            GLuint id = (GLuint)(intptr_t)banner.srv;
-            glDeleteTextures(1, &id);
+        GLuint id = (GLuint)(intptr_t)banner.srv;
+        glDeleteTextures(1, &id);
 #endif
-            banner.srv = nullptr;
-        }
+        banner = BannerTexture{};
+        bannerLoaded = false;
     }
-#ifndef _WIN32
-    bool url_exists(const std::string& url) {
-        CURL* curl = curl_easy_init();
-        if (!curl) return false;
-
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L); // HEAD
-        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
-        curl_easy_setopt(curl, ERROR_TIMEOUT, 10L);
-
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
 
-        return res == CURLE_OK;
+    void Game::releaseBanner() {
+        if(bannerStatus != BannerLoaded) return;
+        TextureCache::instance().remove(*this);
+        freeBanner();
+        bannerStatus = BannerNotLoaded;
     }
-#endif
 
     void Game::launchAsync() {
         if(status.load() != GameStatus::Idle) return;
 
         status.store(GameStatus::Launching);
-        
-        std::thread([this](){
+        LaunchMetrics::instance().begin(name);
+
+#ifdef _WIN32
+        // Blocks until the game exits
+        Executor::instance().submit(Executor::Process, [this, self = weak_from_this().lock()](){
             try {
-                auto start = std::chrono::steady_clock::now();
+                LaunchSession session;
+                session.game = name;
+                session.start = std::chrono::system_clock::now();
                 
                 launch();
                 
-                auto end = std::chrono::steady_clock::now();
-                auto elapsedMinutes = std::chrono::duration_cast<std::chrono::minutes>(end - start).count();
-
-                if (steamAppId <= 0) {
-                     PlaytimeManager::instance().addPlaytime(name, (int)elapsedMinutes);
-                }
+                session.end = std::chrono::system_clock::now();
+                session.gameSeen = true;
+                session.peakProcesses = 1;
+                PlaytimeManager::instance().recordSession(session, launcher == STEAM);
 
                 status.store(GameStatus::Idle);
                 gameState = STOPPED;
@@ -166,7 +173,20 @@ namespace MultiLauncher {
                 status.store(GameStatus::Idle);
                 gameState = STOPPED;
             }
-        }).detach();
+        });
+#else
+        // Returns right after fork; SessionTracker reports the end of the session
+        launch();
+#endif
+    }
+
+    void Game::endSession(const LaunchSession& session) {
+        PlaytimeManager::instance().recordSession(session, launcher == STEAM);
+        GameStatus current = status.load();
+        if (current == GameStatus::Launching || current == GameStatus::Running) {
+            status.store(GameStatus::Idle);
+            gameState = STOPPED;
+        }
     }
 
     const void Game::launch() {
@@ -190,6 +210,7 @@ namespace MultiLauncher {
 
             if (ShellExecuteExA(&shExInfo))
             {
+                LaunchMetrics::instance().spawned(name);
                 // Background poller will update to Running when process is detected
                 status = GameStatus::Launching;
                 
@@ -237,6 +258,7 @@ namespace MultiLauncher {
 
         if (CreateProcessA(NULL, (LPSTR)cmdLine.c_str(), NULL, NULL, TRUE, 0, NULL, workDir.c_str(), &si, &pi)) 
         {
+            LaunchMetrics::instance().spawned(name);
             status = GameStatus::Launching;
             
             CloseHandle(hChildStd_OUT_Wr);
@@ -268,118 +290,29 @@ namespace MultiLauncher {
             
             pid_t pid = fork();
             if (pid == 0) {
-                // Child process
+                // Child process: own session, so the whole game tree can be told apart
+                setsid();
                 if (launcher == STEAM) {
                     execlp("xdg-open", "xdg-open", exePath.c_str(), nullptr);
                 } else {
                     execl(exePath.c_str(), exePath.c_str(), nullptr);
                 }
-                exit(1);
+                _exit(1);
             } else if (pid > 0) {
                 // Parent process
                 status = GameStatus::Launching;
-                int statusCode;
-                waitpid(pid, &statusCode, 0);
+                LaunchMetrics::instance().spawned(name);
+                // the game may be dropped by a rescan while its session is still alive
+                SessionTracker::instance().track(pid, name, executableName, [this, self = weak_from_this().lock()](const LaunchSession& session) {
+                    endSession(session);
+                });
             } else {
                 Logger::instance().error("Failed to fork process for: " + name);
+                status = GameStatus::Idle;
             }
 #endif
     }
 
-#ifdef _WIN32
-    bool Game::LoadTextureFromFile(ID3D11Device* device, const wchar_t* filename, BannerTexture& out_banner) const {
-
-        if (!device) return false;
-
-        char str[1024];
-        WideCharToMultiByte(CP_UTF8, 0, filename, -1, str, 1024, NULL, NULL);
-
-        Logger::instance().info(std::string("Attempting to load banner from: ") + str);
-
-        int image_width = 0;
-        int image_height = 0;
-        int channels = 0;
-        unsigned char* image_data = stbi_load(str, &image_width, &image_height, &channels, 4);
-        if (image_data == NULL) {
-            Logger::instance().error(std::string("Failed to load image: ") + str + " - " + stbi_failure_reason());
-            return false;
-        }
-
-        // Create texture
-        D3D11_TEXTURE2D_DESC desc;
-        ZeroMemory(&desc, sizeof(desc));
-        desc.Width = image_width;
-        desc.Height = image_height;
-        desc.MipLevels = 1;
-        desc.ArraySize = 1;
-        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        desc.SampleDesc.Count = 1;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        desc.CPUAccessFlags = 0;
-
-        ID3D11Texture2D* pTexture = NULL;
-        D3D11_SUBRESOURCE_DATA subResource;
-        subResource.pSysMem = image_data;
-        subResource.SysMemPitch = desc.Width * 4;
-        subResource.SysMemSlicePitch = 0;
-        device->CreateTexture2D(&desc, &subResource, &pTexture);
-
-        if(pTexture == NULL) {
-            stbi_image_free(image_data);
-            return false;
-        }
-
-        // Create texture view
-        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
-        ZeroMemory(&srvDesc, sizeof(srvDesc));
-        srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = desc.MipLevels;
-        srvDesc.Texture2D.MostDetailedMip = 0;
-        device->CreateShaderResourceView(pTexture, &srvDesc, &out_banner.srv);
-        pTexture->Release();
-
-        out_banner.width = image_width;
-        out_banner.height = image_height;
-        stbi_image_free(image_data);
-
-        return true;
-    }
-#else
-    bool Game::LoadTextureFromFile(const char* filename, BannerTexture& out_banner) const {
-        int image_width = 0;
-        int image_height = 0;
-        int channels = 0;
-        unsigned char* image_data = stbi_load(filename, &image_width, &image_height, &channels, 4);
-        if (image_data == NULL) {
-            Logger::instance().error(std::string("Failed to load image: ") + filename + " - " + stbi_failure_reason());
-            return false;
-        }
-
-        GLuint image_texture;
-        glGenTextures(1, &image_texture);
-        glBindTexture(GL_TEXTURE_2D, image_texture);
-
-        // Setup filtering parameters for display
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // Upload pixels into texture
-#if defined(GL_UNPACK_ROW_LENGTH) && !defined(__EMSCRIPTEN__)
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-#endif
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-        stbi_image_free(image_data);
-
-        out_banner.srv = (void*)(intptr_t)image_texture;
-        out_banner.width = image_width;
-        out_banner.height = image_height;
-
-        return true;
-    }
-#endif
-
     static std::string makeBannerKey(const std::string& name) {
         std::string s = name;
         std::transform(s.begin(), s.end(), s.begin(), 
@@ -390,39 +323,97 @@ namespace MultiLauncher {
         return s;
     }
 
+    // Hands the file to the uploader; the banner shows once it is on the GPU.
+    // A banner already shown (a smaller variant) stays up until then.
+    void Game::decodeBanner(const std::string& file) {
+        bannerStatus = BannerDecoding;
+        bannerFile = file;
+        bool cached = file.starts_with("assets/cache/");
+        int width = bannerWidth;
+        auto decode = [file, width, cached]() { return BannerVariants::load(file, width, cached); };
+        TextureUploader::instance().load(file, decode, [this, self = weak_from_this().lock()](BannerTexture texture) {
+            if(!texture.srv){
+                // keep a smaller variant rather than nothing, and stop asking for a larger one
+                banner.downscaled = false;
+                bannerStatus = banner.srv ? BannerLoaded : BannerFailed;
+                return;
+            }
+            TextureCache::instance().remove(*this);
+            freeBanner();
+            banner = texture;
+            bannerLoaded = true;
+            bannerStatus = BannerLoaded;
+            TextureCache::instance().add(*this, texture.bytes);
+        });
+    }
+
+    // Shared by both loadBanner()s while a banner is shown or on its way
+    bool Game::bannerShown(int displayWidth) {
+        if (bannerStatus == BannerDecoding) {
+            // a larger variant is on its way; keep drawing the current one
+            if (!banner.srv) return false;
+            TextureCache::instance().touch(*this);
+            return true;
+        }
+        TextureCache::instance().touch(*this);
+        if (banner.downscaled && displayWidth > banner.width) {
+            bannerWidth = displayWidth;
+            decodeBanner(bannerFile);
+        }
+        return true;
+    }
+
+    // Takes the texture of the game a rescan replaced, so the banner stays up.
+    // If that game's banner is still on its way, waits for it.
+    void Game::adoptBanner() {
+        auto state = replaced->bannerStatus.load();
+        if (state == BannerDownloading || state == BannerDecoding) return;
+        if (state == BannerLoaded && replaced->banner.srv) {
+            TextureCache::instance().remove(*replaced);
+            banner = replaced->banner;
+            bannerFile = std::move(replaced->bannerFile);
+            bannerWidth = replaced->bannerWidth;
+            bannerLoaded = true;
+            bannerStatus = BannerLoaded;
+            replaced->banner = BannerTexture{};
+            replaced->bannerLoaded = false;
+            replaced->bannerStatus = BannerNotLoaded;
+            TextureCache::instance().add(*this, banner.bytes);
+        }
+        replaced.reset();
+    }
+
 #ifdef _WIN32
-    bool Game::loadBanner(ID3D11Device* device) {
-        if (bannerStatus == BannerLoaded) return true;
+    bool Game::loadBanner(ID3D11Device* device, int displayWidth) {
+        if (replaced) {
+            adoptBanner();
+            if (replaced) return false;
+        }
+        if (bannerStatus == BannerLoaded || bannerStatus == BannerDecoding) return bannerShown(displayWidth);
         if (bannerStatus == BannerDownloading) return false;
         if (bannerStatus == BannerFailed) return false;
 
-        // Ready to load texture from disk (Main Thread)
+        // Ready to decode from disk
         if (bannerStatus == BannerReadyToLoad) {
+            bannerWidth = displayWidth;
             std::string key = makeBannerKey(name);
             std::vector<std::string> exts = { ".jpg", ".png" };
             
             // Check steam cache first
             if (steamAppId > 0) {
-                 std::wstring local = L"assets/cache/" + std::to_wstring(steamAppId) + L"_hero.jpg";
+                 std::string local = "assets/cache/" + std::to_string(steamAppId) + "_hero.jpg";
                  if(std::filesystem::exists(local)) {
-                     if(LoadTextureFromFile(device, local.c_str(), banner)){
-                        bannerLoaded = true;
-                        bannerStatus = BannerLoaded;
-                        return true;
-                     }
+                     decodeBanner(local);
+                     return false;
                  }
             }
             
             // Local fallbacks
             for(const auto& ext : exts) {
                 std::string pathStr = "assets/banners/" + key + ext;
-                std::wstring wpath(pathStr.begin(), pathStr.end());
                 if(std::filesystem::exists(pathStr)) {
-                     if(LoadTextureFromFile(device, wpath.c_str(), banner)){
-                        bannerLoaded = true;
-                        bannerStatus = BannerLoaded;
-                        return true;
-                     }
+                     decodeBanner(pathStr);
+                     return false;
                 }
             }
             // If we reached here, even though we were ready to load, something failed
@@ -445,7 +436,7 @@ namespace MultiLauncher {
 
             // Needs download
             bannerStatus = BannerDownloading;
-            std::thread([this, local]() {
+            Executor::instance().submit(Executor::Io, [this, self = weak_from_this().lock(), local]() {
                 std::wstring url = L"https://cdn.cloudflare.steamstatic.com/steam/apps/" + std::to_wstring(steamAppId) + L"/library_hero.jpg";
                 if (!DownloadFile(url, local)) {
                     // Cleanup
@@ -457,8 +448,10 @@ namespace MultiLauncher {
                         return;
                     }
                 }
+                // display-sized variants before the first load
+                BannerVariants::generate(std::filesystem::path(local).string());
                 bannerStatus = BannerReadyToLoad;
-            }).detach();
+            });
 
             return false;
         }
@@ -479,21 +472,23 @@ namespace MultiLauncher {
         return false;
     }
 #else
-    bool Game::loadBanner() {
-        if (bannerStatus == BannerLoaded) return true;
+    bool Game::loadBanner(int displayWidth) {
+        if (replaced) {
+            adoptBanner();
+            if (replaced) return false;
+        }
+        if (bannerStatus == BannerLoaded || bannerStatus == BannerDecoding) return bannerShown(displayWidth);
         if (bannerStatus == BannerDownloading) return false;
         if (bannerStatus == BannerFailed) return false;
 
-        // Ready to load texture from disk (Main Thread)
+        // Ready to decode from disk
         if (bannerStatus == BannerReadyToLoad) {
+            bannerWidth = displayWidth;
             if (steamAppId > 0) {
                 std::string local = "assets/cache/" + std::to_string(steamAppId) + "_hero.jpg";
                 if(std::filesystem::exists(local)) {
-                     if(LoadTextureFromFile(local.c_str(), banner)){
-                        bannerLoaded = true;
-                        bannerStatus = BannerLoaded;
-                        return true;
-                    }
+                    decodeBanner(local);
+                    return false;
                 }
             }
              // Local fallback
@@ -502,11 +497,8 @@ namespace MultiLauncher {
             for(const auto& ext : exts) {
                 std::string pathStr = "assets/banners/" + key + ext;
                 if(std::filesystem::exists(pathStr)) {
-                     if(LoadTextureFromFile(pathStr.c_str(), banner)){
-                        bannerLoaded = true;
-                        bannerStatus = BannerLoaded;
-                        return true;
-                     }
+                     decodeBanner(pathStr);
+                     return false;
                 }
             }
              // If we reached here, even though we were ready to load, something failed
@@ -531,43 +523,21 @@ namespace MultiLauncher {
             // Needs download
             bannerStatus = BannerDownloading;
             
-            std::thread([this, local]() {
-                Logger::instance().info("Downloading banner for appid " + std::to_string(steamAppId));
-                std::string url = "https://cdn.cloudflare.steamstatic.com/steam/apps/" + std::to_string(steamAppId) + "/library_hero.jpg";
-                
-                auto tryDownload = [&](const std::string& u) -> bool {
-                    if(!url_exists(u)) return false;
-                    
-                    CURL* curl = curl_easy_init();
-                    if(!curl) return false;
-                    
-                    FILE* file = fopen(local.c_str(), "wb");
-                    if(!file){
-                        curl_easy_cleanup(curl);
-                        return false;
-                    }
-                    curl_easy_setopt(curl, CURLOPT_URL, u.c_str());
-                    curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
-                    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
-                    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-                    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-                    
-                    CURLcode res = curl_easy_perform(curl);
-                    fclose(file);
-                    curl_easy_cleanup(curl);
-                    return res == CURLE_OK;
-                };
-
-                if(!tryDownload(url)){
-                    url = "https://cdn.cloudflare.steamstatic.com/steam/apps/" + std::to_string(steamAppId) + "/header.jpg";
-                    if(!tryDownload(url)){
-                         if(std::filesystem::exists(local)) std::filesystem::remove(local);
-                         bannerStatus = BannerFailed;
-                         return;
-                    }
+            Logger::instance().info("Downloading banner for appid " + std::to_string(steamAppId));
+            auto& fetcher = BannerFetcher::instance();
+            bool queued = fetcher.fetch(fetcher.steamUrls(steamAppId), local, [this, self = weak_from_this().lock(), local](bool ok) {
+                if(!ok) {
+                    bannerStatus = BannerFailed;
+                    return;
                 }
-                bannerStatus = BannerReadyToLoad;
-            }).detach();
+                // display-sized variants before the first load, off the fetcher thread
+                bool sized = Executor::instance().submit(Executor::Background, [this, self, local]() {
+                    BannerVariants::generate(local);
+                    bannerStatus = BannerReadyToLoad;
+                });
+                if(!sized) bannerStatus = BannerReadyToLoad;
+            });
+            if(!queued) bannerStatus = BannerFailed;
 
             return false;
         }
@@ -589,11 +559,22 @@ namespace MultiLauncher {
 #endif
 
     void Game::updateStatus() {
-        bool running = isProcessRunning(executableName);
+        updateStatus(ProcessSnapshot::capture());
+    }
+
+    void Game::updateStatus(const ProcessSnapshot& processes) {
+        bool running = processes.contains(executableName);
         if (running) {
             status = GameStatus::Running;
         } else {
-            if (status != GameStatus::Launching) {
+            GameStatus current = status.load();
+            // Install states belong to EpicProvider, not the process table
+            if (current == GameStatus::Downloading || current == GameStatus::Installing ||
+                current == GameStatus::Error || current == GameStatus::Paused ||
+                current == GameStatus::Queued) {
+                return;
+            }
+            if (current != GameStatus::Launching) {
                 status = GameStatus::Idle;
                 gameState = STOPPED;
             }
@@ -613,78 +594,7 @@ namespace MultiLauncher {
     }
 
     bool Game::isProcessRunning(const std::string& processName) const {
-        #ifdef _WIN32
-        bool found = false;
-        HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (hSnapshot != INVALID_HANDLE_VALUE) {
-            PROCESSENTRY32W pe32;
-            pe32.dwSize = sizeof(PROCESSENTRY32W);
-            if (Process32FirstW(hSnapshot, &pe32)) {
-                // Case-insensitive comparison
-                std::wstring searchName = stringToWstring(processName);
-                std::transform(searchName.begin(), searchName.end(), searchName.begin(), ::tolower);
-
-                do {
-                    std::wstring currentProcess = pe32.szExeFile;
-                    std::transform(currentProcess.begin(), currentProcess.end(), currentProcess.begin(), ::tolower);
-
-                    if (searchName == currentProcess) {
-                        found = true;
-                        break;
-                    }
-                } while (Process32NextW(hSnapshot, &pe32));
-            }
-            CloseHandle(hSnapshot);
-        }
-        return found;
-        #else
-        // Linux
-        DIR* dir = opendir("/proc");
-        if (dir == nullptr) return false;
-        
-        bool found = false;
-        struct dirent* entry;
-        
-        while ((entry = readdir(dir)) != nullptr) {
-            // Skip non-numeric directories
-            if (entry->d_type != DT_DIR) continue;
-            
-            bool isNumeric = true;
-            for (char* c = entry->d_name; *c; c++) {
-                if (!isdigit(*c)) {
-                    isNumeric = false;
-                    break;
-                }
-            }
-            if (!isNumeric) continue;
-            
-            // Read the cmdline file
-            std::string cmdlinePath = std::string("/proc/") + entry->d_name + "/cmdline";
-            std::ifstream cmdlineFile(cmdlinePath);
-            if (!cmdlineFile.is_open()) continue;
-            
-            std::string cmdline;
-            std::getline(cmdlineFile, cmdline, '\0');
-            cmdlineFile.close();
-            
-            // Extract executable name from path
-            size_t lastSlash = cmdline.find_last_of('/');
-            std::string exeName = (lastSlash != std::string::npos) ? cmdline.substr(lastSlash + 1) : cmdline;
-            
-            // Compare case-insensitively
-            std::string searchName = processName;
-            std::transform(searchName.begin(), searchName.end(), searchName.begin(), ::tolower);
-            std::transform(exeName.begin(), exeName.end(), exeName.begin(), ::tolower);
-            
-            if (searchName == exeName) {
-                found = true;
-                break;
-            }
-        }
-        
-        closedir(dir);
-        return found;
-        #endif
+        return ProcessSnapshot::capture().contains(processName);
     }
 
 }
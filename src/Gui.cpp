@@ -1,10 +1,19 @@
 #include "../include/MultiLauncher/Gui.hpp"
 #include "../include/MultiLauncher/Logger.hpp"
 #include "../include/MultiLauncher/EpicProvider.hpp"
+#include "../include/MultiLauncher/DownloadQueue.hpp"
+#include "../include/MultiLauncher/TransferScheduler.hpp"
 #include "../include/external/imgui/imgui_impl_dx11.h"
 #include "../include/external/imgui/imgui_impl_win32.h"
 #include "../include/external/imgui/imgui.h"
 #include "../include/external/imgui/imgui_internal.h"
+#include "../include/MultiLauncher/TextureUploader.hpp"
+#include "../include/MultiLauncher/TextureCache.hpp"
+#include "../include/MultiLauncher/Executor.hpp"
+// decoded images come from and go back to the pool
+#define STBI_MALLOC(size) MultiLauncher::PixelPool::instance().allocate(size)
+#define STBI_REALLOC(p, size) MultiLauncher::PixelPool::instance().reallocate(p, size)
+#define STBI_FREE(p) MultiLauncher::PixelPool::instance().release(p)
 #define STB_IMAGE_IMPLEMENTATION
 #include "../include/external/stb_image.h"
 #include "../include/MultiLauncher/PlaytimeManager.hpp"
@@ -12,6 +21,7 @@
 #include <cfloat>
 #include <thread>
 #include <algorithm> 
+#include <ctime>
 #ifdef _WIN32
     #include <windows.h>
     #include <d3d11.h>
@@ -187,6 +197,7 @@ void Gui::init(HWND hwnd, ID3D11Device* device, ID3D11DeviceContext* deviceConte
     pd3dDevice_ = device;
     pd3dDeviceContext_ = deviceContext;
     mainRenderTargetView_ = rtv;
+    TextureUploader::instance().init(device, deviceContext);
 
     // Rendering window in dark mode - DwmSetWindowAttribute()
     BOOL darkMode = TRUE;
@@ -383,6 +394,7 @@ void Gui::init(void* window) {
     
     ImGui_ImplGlfw_InitForOpenGL((GLFWwindow*)window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
+    TextureUploader::instance().init([](const char* name) { return (void*)glfwGetProcAddress(name); });
 
     g_gui_instance = this;
 
@@ -394,6 +406,8 @@ void Gui::init(void* window) {
 #endif
 
 void Gui::shutdown(){
+    TextureCache::instance().releaseAll();
+    TextureUploader::instance().shutdown();
 #ifdef _WIN32
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
@@ -426,7 +440,13 @@ void Gui::shutdown(){
 }
 
 void Gui::render(GameManager& manager) {
-    auto lock = manager.lockGames();
+    // Lock-free: scans and process checks publish a new snapshot instead of
+    // blocking the frame on gamesMutex
+    auto snapshot = manager.snapshot();
+    // banners decoded since the last frame, within the frame's upload budget
+    TextureUploader::instance().uploadFrame();
+    // least recently drawn banners go once over budget
+    TextureCache::instance().beginFrame();
     ImGuiViewport* viewport = ImGui::GetMainViewport();
     ImGui::SetNextWindowPos(viewport->Pos);
     ImGui::SetNextWindowSize(viewport->Size);
@@ -454,7 +474,7 @@ void Gui::render(GameManager& manager) {
         ImGui::DockBuilderSetNodeSize(dockspace_id, viewport->Size);
         ImGuiID dock_main_id = dockspace_id;
 
-        // Split: left 40% for Games, bottom 25% for Logs, rest for Details
+        // Split: left 40% for Games, bottom 25% for Logs, Downloads and Debug, rest for Details
         ImGuiID dock_left = 0, dock_bottom = 0;
         ImGui::DockBuilderSplitNode(dock_main_id, ImGuiDir_Left, 0.40f, &dock_left, &dock_main_id);
         ImGui::DockBuilderSplitNode(dock_main_id, ImGuiDir_Down, 0.25f, &dock_bottom, &dock_main_id);
@@ -462,6 +482,8 @@ void Gui::render(GameManager& manager) {
         ImGui::DockBuilderDockWindow("Games", dock_left);
         ImGui::DockBuilderDockWindow("Details", dock_main_id);
         ImGui::DockBuilderDockWindow("Logs", dock_bottom);
+        ImGui::DockBuilderDockWindow("Downloads", dock_bottom);
+        ImGui::DockBuilderDockWindow("Debug", dock_bottom);
 
         ImGui::DockBuilderFinish(dockspace_id);
         dock_layout_initialized = true;
@@ -511,6 +533,9 @@ void Gui::render(GameManager& manager) {
     if (ImGui::Button("Refresh Game List", ImVec2(ImGui::GetContentRegionAvail().x, 30))) {
         manager.scanAsync(true);
     }
+    if (manager.isScanning()) {
+        ImGui::TextDisabled("Scanning libraries...");
+    }
     ImGui::Spacing();
 
 
@@ -582,10 +607,9 @@ void Gui::render(GameManager& manager) {
         ImGui::PopFont();
 
         // Filtering
-        std::vector<Game*> displayList;
-        auto& games = manager.getGames();
-        for(auto& uptr : games) {
-            Game* game = uptr.get();
+        std::vector<const StatusSnapshot::Entry*> displayList;
+        for(const auto& entry : snapshot->games) {
+            Game* game = entry.game.get();
              // text filter
             if (game_filter[0] &&
                 game->getName().find(game_filter) == std::string::npos)
@@ -601,31 +625,31 @@ void Gui::render(GameManager& manager) {
                 if ((launcher_filter & LF_GOG) && (L.find("GOG") != std::string::npos || L.find("gog") != std::string::npos)) match = true;
                 if (!match) continue;
             }
-            displayList.push_back(game);
+            displayList.push_back(&entry);
         }
 
         // Sort
         if(sort_mode == 0) { // Name
-            std::sort(displayList.begin(), displayList.end(), [](Game* a, Game* b){
-                return a->getName() < b->getName();
+            std::sort(displayList.begin(), displayList.end(), [](const auto* a, const auto* b){
+                return a->game->getName() < b->game->getName();
             });
         } else if (sort_mode == 1) { // Launcher
-            std::sort(displayList.begin(), displayList.end(), [](Game* a, Game* b){
-                if(a->getLauncher() != b->getLauncher())
-                    return a->getLauncher() < b->getLauncher();
-                return a->getName() < b->getName(); // secondary sort by name
+            std::sort(displayList.begin(), displayList.end(), [](const auto* a, const auto* b){
+                if(a->game->getLauncher() != b->game->getLauncher())
+                    return a->game->getLauncher() < b->game->getLauncher();
+                return a->game->getName() < b->game->getName(); // secondary sort by name
             });
         }
 
         // Render games
         for (size_t i = 0; i < displayList.size(); ++i)
         {
-            Game* game = displayList[i];
+            Game* game = displayList[i]->game.get();
             
             // Use pointer as ID for stability
             ImGui::PushID(game);
 
-            auto status = game->status.load();
+            auto status = displayList[i]->status;
 
             const char* label = "Launch";
             if(status == Game::GameStatus::Launching) label = "Launching...";
@@ -652,6 +676,7 @@ void Gui::render(GameManager& manager) {
 
             if(ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0)){
                 game->launchAsync();
+                manager.refreshStatus();
             }
 
             ImGui::SameLine();
@@ -660,11 +685,12 @@ void Gui::render(GameManager& manager) {
             ImGui::TextDisabled("%s", game->getLauncher().c_str());
             
             if (status == Game::GameStatus::Downloading || status == Game::GameStatus::Installing) {
+                InstallProgress progress = game->getInstallProgress();
                 ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.3f, 0.65f, 1.0f, 1.0f));
-                ImGui::ProgressBar(game->getProgress(), ImVec2(ImGui::GetContentRegionAvail().x * 0.8f, 4), "");
+                ImGui::ProgressBar(progress.fraction(), ImVec2(ImGui::GetContentRegionAvail().x * 0.8f, 4), "");
                 ImGui::PopStyleColor();
                 ImGui::SameLine();
-                ImGui::TextDisabled("%.0f%%", game->getProgress() * 100.0f);
+                ImGui::TextDisabled("%.0f%%", progress.percent);
             }
             ImGui::EndGroup();
 
@@ -672,13 +698,19 @@ void Gui::render(GameManager& manager) {
             ImGui::TableSetColumnIndex(1);
 
             if (status == Game::GameStatus::Downloading || status == Game::GameStatus::Installing) {
-                if (ImGui::Button("Cancel", ImVec2(-FLT_MIN, 28))) {
-                    ProcessRunner::runAsync("tools/legendary/legendary.exe cancel", [](int){});
-                    game->status = Game::GameStatus::Idle;
+                if (ImGui::Button("Pause", ImVec2(-FLT_MIN, 28))) {
+                    DownloadQueue::instance().pause(game->getName());
+                    manager.refreshStatus();
                 }
-            } else if (status == Game::GameStatus::Error) {
+            } else if (status == Game::GameStatus::Error || status == Game::GameStatus::Paused) {
                 if (ImGui::Button("Resume", ImVec2(-FLT_MIN, 28))) {
-                    EpicProvider::installGame(*game);
+                    DownloadQueue::instance().enqueue(*game);
+                    manager.refreshStatus();
+                }
+            } else if (status == Game::GameStatus::Queued) {
+                if (ImGui::Button("Unqueue", ImVec2(-FLT_MIN, 28))) {
+                    DownloadQueue::instance().remove(game->getName());
+                    manager.refreshStatus();
                 }
             } else {
                 if(disabled){
@@ -692,6 +724,7 @@ void Gui::render(GameManager& manager) {
                     } else {
                         game->launchAsync();
                     }
+                    manager.refreshStatus();
                 }
                 if(disabled) ImGui::EndDisabled();
             }
@@ -711,14 +744,16 @@ void Gui::render(GameManager& manager) {
 
     if (!selected_game_name.empty()) {
         bool found = false;
-        for (auto& g : manager.getGames()) {
+        for (const auto& entry : snapshot->games) {
+            const auto& g = entry.game;
             if (g->getName() == selected_game_name) {
                 
-                // Trigger load / update state
+                // Trigger load / update state; the banner variant is picked for the panel's pixel width
+                int displayWidth = (int)(ImGui::GetContentRegionAvail().x * ImGui::GetIO().DisplayFramebufferScale.x);
 #ifdef _WIN32
-                bool loaded = g->loadBanner(pd3dDevice_);
+                bool loaded = g->loadBanner(pd3dDevice_, displayWidth);
 #else
-                bool loaded = g->loadBanner();
+                bool loaded = g->loadBanner(displayWidth);
 #endif
                 
                 if (loaded) {
@@ -763,14 +798,14 @@ void Gui::render(GameManager& manager) {
                          // Check why it's not loaded
                          auto status = g->bannerStatus.load(); // Public access
                          
-                         if(status == Game::BannerDownloading) {
+                         if(status == Game::BannerDownloading || status == Game::BannerDecoding) {
                              // Center Spinner
                              float spinnerRadius = 20.0f;
                              ImGui::SetCursorPosX(ImGui::GetWindowSize().x * 0.5f - spinnerRadius);
                              ImGui::SetCursorPosY(ImGui::GetWindowSize().y * 0.5f - spinnerRadius);
                              DrawSpinner("##spinner", spinnerRadius, 4, ImVec4(0.2f, 0.55f, 0.90f, 1.0f));
                              
-                             const char* txt = "Downloading Banner...";
+                             const char* txt = status == Game::BannerDownloading ? "Downloading Banner..." : "Loading Banner...";
                              auto txtW = ImGui::CalcTextSize(txt).x;
                              ImGui::SetCursorPosX(ImGui::GetWindowSize().x * 0.5f - txtW * 0.5f);
                              ImGui::TextDisabled("%s", txt);
@@ -792,16 +827,57 @@ void Gui::render(GameManager& manager) {
                 ImGui::Text("Name: %s", g->getName().c_str());
                 ImGui::Text("Launcher: %s", g->getLauncher().c_str());
                 
-                float hours = PlaytimeManager::instance().getHours(g->getName(), g->getSteamAppId());
+                auto& playtime = PlaytimeManager::instance();
+                float hours = playtime.getHours(g->getName(), g->getSteamAppId());
                 if (hours > 0.0f) {
                     ImGui::Text("Playtime: %.1f h", hours);
+                } else if (!playtime.isReady()) {
+                    ImGui::TextDisabled("Playtime: loading...");
                 } else {
                     ImGui::Text("Playtime: --");
                 }
+                if (auto session = SessionTracker::instance().active(g->getName())) {
+                    ImGui::Text("Session: %d min, %d processes (peak %d)", session->minutes(), session->processes, session->peakProcesses);
+                } else if (auto last = playtime.getLastSession(g->getName())) {
+                    ImGui::Text("Last session: %d min, peak %d processes", last->minutes(), last->peakProcesses);
+                }
+                if (entry.status == Game::GameStatus::Running) {
+                    if (auto res = ResourceMonitor::instance().history(g->getName())) {
+                        const auto& s = res->latest;
+                        ImGui::Text("CPU: %.0f%%   Memory: %.0f MB   Threads: %d (%d processes)", s.cpuPercent,
+                                    s.rssBytes / (1024.0 * 1024.0), s.threads, s.processes);
+                        if (s.hasIo) {
+                            ImGui::Text("Disk: read %.1f MB/s, write %.1f MB/s", s.readBytesPerSec / (1024.0 * 1024.0),
+                                        s.writeBytesPerSec / (1024.0 * 1024.0));
+                        }
+                        ImVec2 spark(ImGui::GetContentRegionAvail().x, 32);
+                        ImGui::PlotLines("##cpu", res->cpu.data(), res->cpu.size(), res->cpu.offset(), "CPU", 0.0f, FLT_MAX, spark);
+                        ImGui::PlotLines("##rss", res->rssMb.data(), res->rssMb.size(), res->rssMb.offset(), "Memory", 0.0f, FLT_MAX, spark);
+                        if (s.hasIo) {
+                            ImGui::PlotLines("##read", res->readMbps.data(), res->readMbps.size(), res->readMbps.offset(), "Read", 0.0f, FLT_MAX, spark);
+                            ImGui::PlotLines("##write", res->writeMbps.data(), res->writeMbps.size(), res->writeMbps.offset(), "Write", 0.0f, FLT_MAX, spark);
+                        }
+                    }
+                }
+                int64_t lastPlayed = g->getSteamAppId() > 0 ? playtime.getLastPlayed(g->getSteamAppId()) : 0;
+                if (lastPlayed > 0) {
+                    std::time_t t = (std::time_t)lastPlayed;
+                    char date[32];
+                    if (std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&t))) {
+                        ImGui::Text("Last played: %s", date);
+                    }
+                }
+                static const char* stageLabels[] = { "process", "detected", "window" };
+                for (int stage = 0; stage < LaunchMetrics::StageCount; ++stage) {
+                    if (auto p = LaunchMetrics::instance().percentiles(g->getName(), (LaunchMetrics::Stage)stage)) {
+                        ImGui::TextDisabled("Launch to %s: p50 %.1f s, p95 %.1f s", stageLabels[stage],
+                                            p->first / 1000.0, p->second / 1000.0);
+                    }
+                }
 
 
                 const char* btnLabel = "Launch";
-                auto status = g->status.load();
+                auto status = entry.status;
                 if(status == Game::GameStatus::Launching) btnLabel = "Launching...";
                 else if(status == Game::GameStatus::Running) btnLabel = "Running";
                 
@@ -809,11 +885,29 @@ void Gui::render(GameManager& manager) {
                 
                 if (status == Game::GameStatus::Downloading || status == Game::GameStatus::Installing) {
                     ImGui::Text("Status: %s", status == Game::GameStatus::Downloading ? "Downloading" : "Installing");
-                    ImGui::ProgressBar(g->getProgress(), ImVec2(-FLT_MIN, 20));
-                    ImGui::Text("Speed: %s", g->getETA().c_str());
-                    if (ImGui::Button("Cancel Installation", ImVec2(140, 36))) {
-                        ProcessRunner::runAsync("tools/legendary/legendary.exe cancel", [](int){});
-                        g->status = Game::GameStatus::Idle;
+                    InstallProgress progress = g->getInstallProgress();
+                    ImGui::ProgressBar(progress.fraction(), ImVec2(-FLT_MIN, 20));
+                    ImGui::TextUnformatted(progress.toString().c_str());
+                    if (progress.activeTasks) ImGui::TextDisabled("%d active download tasks", progress.activeTasks);
+                    if (ImGui::Button("Pause Installation", ImVec2(140, 36))) {
+                        DownloadQueue::instance().pause(g->getName());
+                        manager.refreshStatus();
+                    }
+                } else if (status == Game::GameStatus::Error || status == Game::GameStatus::Paused ||
+                           status == Game::GameStatus::Queued) {
+                    const char* text = status == Game::GameStatus::Queued ? "Waiting for a download slot" :
+                                       status == Game::GameStatus::Paused ? "Installation paused" : "Installation failed";
+                    ImGui::Text("Status: %s", text);
+                    if (status != Game::GameStatus::Queued) {
+                        if (ImGui::Button("Resume Installation", ImVec2(140, 36))) {
+                            DownloadQueue::instance().enqueue(*g);
+                            manager.refreshStatus();
+                        }
+                        ImGui::SameLine();
+                    }
+                    if (ImGui::Button("Remove from Queue", ImVec2(140, 36))) {
+                        DownloadQueue::instance().remove(g->getName());
+                        manager.refreshStatus();
                     }
                 } else {
                     if(disabled) ImGui::BeginDisabled();
@@ -824,13 +918,15 @@ void Gui::render(GameManager& manager) {
                         } else {
                             g->launchAsync();
                         }
+                        manager.refreshStatus();
                     }
                     if(disabled) ImGui::EndDisabled();
 
                     if (g->getLauncher().find("Epic") != std::string::npos && status == Game::GameStatus::Idle) {
                         ImGui::SameLine();
                         if (ImGui::Button("Install/Repair", ImVec2(120, 36))) {
-                            EpicProvider::installGame(*g);
+                            DownloadQueue::instance().enqueue(*g);
+                            manager.refreshStatus();
                         }
                     }
                 }
@@ -870,6 +966,174 @@ void Gui::render(GameManager& manager) {
     ImGui::EndChild();
     ImGui::End();
 
+    // Downloads Panel
+    ImGui::Begin("Downloads");
+    {
+        auto& queue = DownloadQueue::instance();
+        bool changed = false;
+        int maxConcurrent = queue.maxConcurrent();
+        ImGui::SetNextItemWidth(160);
+        if (ImGui::SliderInt("Parallel installs", &maxConcurrent, 1, DownloadQueue::MaxConcurrentLimit)) {
+            queue.setMaxConcurrent(maxConcurrent);
+            changed = true;
+        }
+
+        // Bandwidth caps in MiB/s, 0 for none; time windows are set in transfer_policy.json
+        auto& transfers = TransferScheduler::instance();
+        auto policy = transfers.policy();
+        const float mib = 1024.0f * 1024.0f;
+        float cap = policy.capBytesPerSec / mib;
+        float playingCap = policy.playingCapBytesPerSec / mib;
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90);
+        ImGui::InputFloat("Limit (MiB/s)", &cap, 0, 0, "%.1f");
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            policy.capBytesPerSec = (uint64_t)(std::max(cap, 0.0f) * mib);
+            transfers.setPolicy(policy);
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(90);
+        ImGui::InputFloat("While playing (MiB/s)", &playingCap, 0, 0, "%.1f");
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            policy.playingCapBytesPerSec = (uint64_t)(std::max(playingCap, 0.0f) * mib);
+            transfers.setPolicy(policy);
+        }
+        uint64_t budget = transfers.budget();
+        ImGui::SameLine();
+        if (budget) ImGui::TextDisabled("Now: %.1f MiB/s", budget / mib);
+        else ImGui::TextDisabled("Now: unlimited");
+        ImGui::Separator();
+
+        auto items = queue.items();
+        if (items.empty()) ImGui::TextDisabled("No installs queued. Use Install/Repair on an Epic game.");
+
+        if (!items.empty() && ImGui::BeginTable("DownloadQueue", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Game", ImGuiTableColumnFlags_WidthStretch, 2.0f);
+            ImGui::TableSetupColumn("Progress", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+            ImGui::TableSetupColumn("Priority", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("##actions", ImGuiTableColumnFlags_WidthFixed, 190.0f);
+            ImGui::TableHeadersRow();
+
+            static const char* stateNames[] = { "Queued", "Installing", "Paused", "Failed" };
+            for (size_t i = 0; i < items.size(); ++i) {
+                const auto& item = items[i];
+                ImGui::PushID(item.game.c_str());
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(item.game.c_str());
+                ImGui::TextDisabled("%s", item.resolved ? stateNames[item.state] : "Not in library yet");
+
+                ImGui::TableSetColumnIndex(1);
+                if (item.resolved) {
+                    InstallProgress progress = item.resolved->getInstallProgress();
+                    ImGui::ProgressBar(progress.fraction(), ImVec2(-FLT_MIN, 0));
+                    if (item.state == DownloadQueue::Active) ImGui::TextDisabled("%s", progress.toString().c_str());
+                }
+
+                ImGui::TableSetColumnIndex(2);
+                int priority = item.priority;
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                if (ImGui::InputInt("##priority", &priority, 1, 10, ImGuiInputTextFlags_EnterReturnsTrue)) {
+                    queue.setPriority(item.game, priority);
+                    changed = true;
+                }
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::BeginDisabled(i == 0);
+                if (ImGui::ArrowButton("##up", ImGuiDir_Up)) { queue.move(item.game, -1); changed = true; }
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                ImGui::BeginDisabled(i + 1 == items.size());
+                if (ImGui::ArrowButton("##down", ImGuiDir_Down)) { queue.move(item.game, 1); changed = true; }
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                if (item.state == DownloadQueue::Active || item.state == DownloadQueue::Queued) {
+                    if (ImGui::Button("Pause")) { queue.pause(item.game); changed = true; }
+                } else {
+                    if (ImGui::Button("Resume")) { queue.resume(item.game); changed = true; }
+                }
+                ImGui::SameLine();
+                ImGui::BeginDisabled(item.state == DownloadQueue::Active);
+                if (ImGui::Button("Remove")) { queue.remove(item.game); changed = true; }
+                ImGui::EndDisabled();
+
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+        // queue changes show on the games' status in the next snapshot
+        if (changed) manager.refreshStatus();
+    }
+    ImGui::End();
+
+    // Debug Panel
+    ImGui::Begin("Debug");
+    {
+        auto& cache = TextureCache::instance();
+        auto stats = cache.stats();
+        const double mib = 1024.0 * 1024.0;
+        char overlay[96];
+        std::snprintf(overlay, sizeof(overlay), "%.0f / %.0f MiB", stats.usedBytes / mib, stats.budgetBytes / mib);
+        ImGui::Text("Banner textures: %zu resident, %llu evicted", stats.textures, (unsigned long long)stats.evictions);
+        ImGui::ProgressBar(stats.budgetBytes ? (float)((double)stats.usedBytes / stats.budgetBytes) : 0.0f, ImVec2(-1, 0), overlay);
+
+        int budgetMiB = (int)(stats.budgetBytes >> 20);
+        ImGui::SetNextItemWidth(200);
+        ImGui::SliderInt("Texture budget (MiB)", &budgetMiB, (int)(TextureCache::MinBudget >> 20), 2048);
+        if (ImGui::IsItemDeactivatedAfterEdit()) cache.setBudget((uint64_t)budgetMiB << 20);
+
+        auto entries = cache.entries();
+        if (!entries.empty() && ImGui::BeginTable("TextureCache", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Game", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            ImGui::TableSetupColumn("Last drawn", ImGuiTableColumnFlags_WidthFixed, 130.0f);
+            ImGui::TableHeadersRow();
+            for (const auto& e : entries) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(e.game.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f MiB", e.bytes / mib);
+                ImGui::TableNextColumn();
+                uint64_t ago = stats.frame - e.lastUsedFrame;
+                if (ago <= 1) ImGui::Text("now");
+                else ImGui::Text("%llu frames ago", (unsigned long long)ago);
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Executor lanes");
+        if (ImGui::BeginTable("ExecutorLanes", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Lane", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Running", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Queued", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableSetupColumn("Peak", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+            ImGui::TableSetupColumn("Avg wait", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Done", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableHeadersRow();
+            for (int lane = 0; lane < Executor::LaneCount; ++lane) {
+                auto laneStats = Executor::instance().stats((Executor::Lane)lane);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(laneStats.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu / %zu", laneStats.running, laneStats.maxWorkers);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", laneStats.queued);
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", laneStats.peakQueued);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f ms", laneStats.avgWaitMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)laneStats.completed);
+            }
+            ImGui::EndTable();
+        }
+    }
+    ImGui::End();
+
 
     ImGui::End(); // End MultiLauncherRoot
 }
@@ -0,0 +1,264 @@
+#include "../include/MultiLauncher/TextureUploader.hpp"
+#include "../include/MultiLauncher/Executor.hpp"
+#include "../include/MultiLauncher/Logger.hpp"
+#ifdef __linux__
+#include <GL/gl.h>
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace MultiLauncher {
+
+#ifndef _WIN32
+    // Buffer objects are not in <GL/gl.h>; loaded in init()
+    namespace {
+        constexpr GLenum PixelUnpackBuffer = 0x88EC;
+        constexpr GLenum StreamDraw = 0x88E0;
+        constexpr GLbitfield MapWrite = 0x0002;
+        constexpr GLbitfield MapInvalidateBuffer = 0x0008;
+        constexpr GLbitfield MapUnsynchronized = 0x0020;
+        void (*genBuffers)(GLsizei, GLuint*) = nullptr;
+        void (*deleteBuffers)(GLsizei, const GLuint*) = nullptr;
+        void (*bindBuffer)(GLenum, GLuint) = nullptr;
+        void (*bufferData)(GLenum, ptrdiff_t, const void*, GLenum) = nullptr;
+        void* (*mapBufferRange)(GLenum, ptrdiff_t, ptrdiff_t, GLbitfield) = nullptr;
+        GLboolean (*unmapBuffer)(GLenum) = nullptr;
+    }
+
+    void TextureUploader::init(const std::function<void*(const char*)>& getProcAddress) {
+        genBuffers = (decltype(genBuffers))getProcAddress("glGenBuffers");
+        deleteBuffers = (decltype(deleteBuffers))getProcAddress("glDeleteBuffers");
+        bindBuffer = (decltype(bindBuffer))getProcAddress("glBindBuffer");
+        bufferData = (decltype(bufferData))getProcAddress("glBufferData");
+        mapBufferRange = (decltype(mapBufferRange))getProcAddress("glMapBufferRange");
+        unmapBuffer = (decltype(unmapBuffer))getProcAddress("glUnmapBuffer");
+        // pixel buffer objects came with GL 2.1, glMapBufferRange with 3.0
+        int major = 0;
+        const char* version = (const char*)glGetString(GL_VERSION);
+        if (version) std::sscanf(version, "%d", &major);
+        usePbo_ = genBuffers && deleteBuffers && bindBuffer && bufferData && mapBufferRange && unmapBuffer && major >= 3;
+        if (usePbo_) genBuffers(1, &pbo_);
+        Logger::instance().info(usePbo_ ? "Banner uploads use pixel buffer objects"
+                                        : "Banner uploads copy from client memory (no pixel buffer objects)");
+        std::lock_guard<std::mutex> lk(m_);
+        ready_ = true;
+    }
+#else
+    void TextureUploader::init(ID3D11Device* device, ID3D11DeviceContext* context) {
+        device_ = device;
+        context_ = context;
+        std::lock_guard<std::mutex> lk(m_);
+        ready_ = true;
+    }
+#endif
+
+    void TextureUploader::load(const std::string& name, std::function<MipImage()> decode, std::function<void(BannerTexture)> done) {
+        auto queuedAt = std::chrono::steady_clock::now();
+        bool queued = Executor::instance().submit(Executor::Interactive, [this, name, decode = std::move(decode), done, queuedAt]() mutable {
+            Job job;
+            job.name = name;
+            job.done = std::move(done);
+            job.queuedAt = queuedAt;
+            auto start = std::chrono::steady_clock::now();
+            job.image = decode();
+            job.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::lock_guard<std::mutex> lk(m_);
+            if (stopping_) return;
+            decoded_.push_back(std::move(job));
+        });
+        if (!queued) {
+            std::lock_guard<std::mutex> lk(m_);
+            if (stopping_) return;
+            Job job;
+            job.name = name;
+            job.done = std::move(done);
+            decoded_.push_back(std::move(job)); // reported as failed next frame
+        }
+    }
+
+    void TextureUploader::uploadFrame() {
+        auto start = std::chrono::steady_clock::now();
+        size_t spent = 0;
+        while (true) {
+            Job* job = nullptr;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                if (!ready_ || decoded_.empty()) return;
+                // deque references survive the decoders' push_back
+                job = &decoded_.front();
+            }
+            bool failed = !job->image;
+            if (!failed && !job->texture.srv) {
+                // allocating the storage can cost as much as a strip; rows start next frame
+                failed = !createTexture(*job);
+                if (!failed) return;
+            }
+            if (!failed) {
+                const auto& levels = job->image.levels();
+                job->frames++;
+                while (job->level < levels.size()) {
+                    const auto& level = levels[job->level];
+                    size_t rowBytes = (size_t)level.width * 4;
+                    size_t budget = std::min(StripBytes, FrameBytes - std::min(spent, FrameBytes));
+                    int rows = (int)std::clamp<size_t>(budget / rowBytes, 1, level.height - job->rowsUploaded);
+                    uploadRows(*job, rows);
+                    spent += rows * rowBytes;
+                    if (job->rowsUploaded == level.height) {
+                        job->level++;
+                        job->rowsUploaded = 0;
+                    }
+                    // a slow driver runs out of time before the bytes run out
+                    if (spent >= FrameBytes || std::chrono::steady_clock::now() - start >= FrameTime) break;
+                }
+                if (job->level < levels.size()) return; // the budget ran out mid-texture
+            }
+
+            Job finished;
+            {
+                std::lock_guard<std::mutex> lk(m_);
+                finished = std::move(decoded_.front());
+                decoded_.pop_front();
+            }
+            if (failed) {
+                freeTexture(finished.texture);
+                finished.done(BannerTexture{});
+            } else {
+                finished.texture.bytes = finished.image.bytes();
+                finished.texture.downscaled = finished.image.downscaled;
+                char msg[320];
+                std::snprintf(msg, sizeof(msg), "Banner %s (%dx%d, %zu levels): decoded in %.1f ms, shown after %.1f ms, uploaded over %d frame(s)",
+                              finished.name.c_str(), finished.image.width(), finished.image.height(),
+                              finished.image.levels().size(), finished.decodeMs,
+                              std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finished.queuedAt).count(),
+                              finished.frames);
+                Logger::instance().info(msg);
+                finished.done(finished.texture);
+            }
+            if (spent >= FrameBytes || std::chrono::steady_clock::now() - start >= FrameTime) return;
+        }
+    }
+
+    void TextureUploader::shutdown() {
+        std::deque<Job> left;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stopping_ = true;
+            ready_ = false;
+            left.swap(decoded_);
+        }
+        for (auto& job : left) freeTexture(job.texture);
+#ifndef _WIN32
+        if (pbo_) deleteBuffers(1, &pbo_);
+        pbo_ = 0;
+#endif
+    }
+
+#ifndef _WIN32
+    bool TextureUploader::createTexture(Job& job) {
+        GLuint id = 0;
+        glGenTextures(1, &id);
+        if (!id) return false;
+        const auto& levels = job.image.levels();
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+        // storage only; the rows follow over the next frames
+        for (size_t i = 0; i < levels.size(); ++i) {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, levels[i].width, levels[i].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        job.texture.srv = (void*)(intptr_t)id;
+        job.texture.width = job.image.width();
+        job.texture.height = job.image.height();
+        return true;
+    }
+
+    void TextureUploader::uploadRows(Job& job, int rows) {
+        int width = job.image.levels()[job.level].width;
+        const unsigned char* src = job.image.level(job.level) + (size_t)job.rowsUploaded * width * 4;
+        size_t bytes = (size_t)rows * width * 4;
+        glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)job.texture.srv);
+#if defined(GL_UNPACK_ROW_LENGTH) && !defined(__EMSCRIPTEN__)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+        void* mapped = nullptr;
+        if (usePbo_) {
+            // Orphan the buffer, so mapping never waits on the previous strip,
+            // and copy the strip in; glTexSubImage2D then only queues the
+            // transfer from the buffer
+            bindBuffer(PixelUnpackBuffer, pbo_);
+            bufferData(PixelUnpackBuffer, (ptrdiff_t)bytes, nullptr, StreamDraw);
+            mapped = mapBufferRange(PixelUnpackBuffer, 0, (ptrdiff_t)bytes, MapWrite | MapInvalidateBuffer | MapUnsynchronized);
+            if (mapped) {
+                std::memcpy(mapped, src, bytes);
+                // false if the buffer was lost meanwhile; the strip is sent again below
+                if (!unmapBuffer(PixelUnpackBuffer)) mapped = nullptr;
+                else glTexSubImage2D(GL_TEXTURE_2D, (GLint)job.level, 0, job.rowsUploaded, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            }
+            // ImGui uploads from client memory; leave no unpack buffer bound
+            bindBuffer(PixelUnpackBuffer, 0);
+        }
+        if (!mapped) {
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)job.level, 0, job.rowsUploaded, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, src);
+        }
+        job.rowsUploaded += rows;
+    }
+
+    void TextureUploader::freeTexture(BannerTexture& texture) {
+        if (!texture.srv) return;
+        GLuint id = (GLuint)(intptr_t)texture.srv;
+        glDeleteTextures(1, &id);
+        texture.srv = nullptr;
+    }
+#else
+    bool TextureUploader::createTexture(Job& job) {
+        if (!device_) return false;
+        D3D11_TEXTURE2D_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        UINT mipLevels = (UINT)job.image.levels().size();
+        desc.Width = job.image.width();
+        desc.Height = job.image.height();
+        desc.MipLevels = mipLevels;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        ID3D11Texture2D* texture = nullptr;
+        device_->CreateTexture2D(&desc, nullptr, &texture);
+        if (!texture) return false;
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        ZeroMemory(&srvDesc, sizeof(srvDesc));
+        srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = mipLevels;
+        device_->CreateShaderResourceView(texture, &srvDesc, &job.texture.srv);
+        texture->Release();
+        if (!job.texture.srv) return false;
+        job.texture.width = job.image.width();
+        job.texture.height = job.image.height();
+        return true;
+    }
+
+    void TextureUploader::uploadRows(Job& job, int rows) {
+        ID3D11Resource* resource = nullptr;
+        job.texture.srv->GetResource(&resource);
+        UINT width = (UINT)job.image.levels()[job.level].width;
+        UINT pitch = width * 4;
+        D3D11_BOX box = { 0, (UINT)job.rowsUploaded, 0, width, (UINT)(job.rowsUploaded + rows), 1 };
+        context_->UpdateSubresource(resource, (UINT)job.level, &box, job.image.level(job.level) + (size_t)job.rowsUploaded * pitch, pitch, 0);
+        resource->Release();
+        job.rowsUploaded += rows;
+    }
+
+    void TextureUploader::freeTexture(BannerTexture& texture) {
+        if (!texture.srv) return;
+        texture.srv->Release();
+        texture.srv = nullptr;
+    }
+#endif
+
+}